@@ -0,0 +1,649 @@
+/*
+ * ArithmeticCircuit.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of ArithmeticCircuit class.
+ */
+#include "ArithmeticCircuit.h"
+#include "FactorKernels.h"
+#include "LogSpace.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace std;
+
+static const char MAGIC[4] = {'B', 'N', 'A', 'C'};
+static const uint32_t VERSION = 1;
+static const int32_t ZERO = 0, ONE = 1; // the first two nodes
+static const size_t LANES = 16;         // batch rows evaluated together
+
+/* start of a circuit file; the arrays follow in the order below */
+struct CircuitHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t model;       // fingerprint of the model it was compiled from
+    uint64_t numNodes;
+    uint64_t numChildren;
+    uint64_t numConstants;
+    int64_t root;
+};
+
+/*
+ * Builder
+ * Purpose: adds nodes to a circuit under construction, folding products
+ *          and sums with 0 and 1 and sharing one node per constant
+ */
+struct Builder {
+    vector<int32_t> &kind, &arg, &childStart, &children;
+    vector<double> &constants;
+    map<double, int32_t> shared;
+
+    int32_t node(int32_t k, int32_t a, size_t numChildren = 0)
+    {
+        kind.push_back(k);
+        arg.push_back(a);
+        childStart.push_back(children.size() - numChildren);
+        return kind.size() - 1;
+    }
+    int32_t constant(double c)
+    {
+        map<double, int32_t>::iterator it = shared.find(c);
+        if (it != shared.end()) {return it->second;}
+        constants.push_back(c);
+        return shared[c] = node(ArithmeticCircuit::CONSTANT,
+                                constants.size() - 1);
+    }
+    int32_t multiply(int32_t a, int32_t b)
+    {
+        if (a == ZERO or b == ZERO) {return ZERO;}
+        if (a == ONE) {return b;}
+        if (b == ONE) {return a;}
+        children.push_back(a);
+        children.push_back(b);
+        return node(ArithmeticCircuit::MUL, 0, 2);
+    }
+    int32_t add(const vector<int32_t> &terms)
+    {
+        int32_t only = ZERO, count = 0;
+        for (size_t i = 0; i < terms.size(); i++) {
+            if (terms[i] != ZERO) {
+                only = terms[i];
+                count++;
+            }
+        }
+        if (count < 2) {return only;}
+        for (size_t i = 0; i < terms.size(); i++) {
+            if (terms[i] != ZERO) {children.push_back(terms[i]);}
+        }
+        return node(ArithmeticCircuit::ADD, 0, count);
+    }
+};
+
+/* a factor whose entries are circuit nodes, last variable fastest */
+struct Symbolic {
+    vector<int> vars, card;
+    vector<int32_t> nodes;
+
+    /*
+     * strides()
+     * Purpose:     stride in this factor of each variable of a list, 0 for
+     *              those not in it
+     */
+    vector<int> strides(const vector<int> &over) const
+    {
+        vector<int> result(over.size(), 0);
+        int stride = 1;
+        for (int i = vars.size() - 1; i >= 0; i--) {
+            for (size_t j = 0; j < over.size(); j++) {
+                if (over[j] == vars[i]) {result[j] = stride;}
+            }
+            stride *= card[i];
+        }
+        return result;
+    }
+};
+
+/*
+ * product()
+ * Purpose:     multiplies two symbolic factors entry by entry
+ * Parameters:  builder and factors
+ * Returns:     factor over the union of their variables
+ */
+static Symbolic product(Builder &b, const Symbolic &x, const Symbolic &y)
+{
+    Symbolic f;
+    f.vars = x.vars;
+    f.card = x.card;
+    for (size_t i = 0; i < y.vars.size(); i++) {
+        if (find(x.vars.begin(), x.vars.end(), y.vars[i]) == x.vars.end()) {
+            f.vars.push_back(y.vars[i]);
+            f.card.push_back(y.card[i]);
+        }
+    }
+    int total = 1;
+    for (size_t i = 0; i < f.card.size(); i++) {
+        total *= f.card[i];
+    }
+    vector<int> sx = x.strides(f.vars), sy = y.strides(f.vars);
+    vector<int> digit(f.vars.size(), 0);
+    int ix = 0, iy = 0;
+    for (int i = 0; i < total; i++) {
+        f.nodes.push_back(b.multiply(x.nodes[ix], y.nodes[iy]));
+        for (int j = f.vars.size() - 1; j >= 0; j--) { // next entry
+            ix += sx[j];
+            iy += sy[j];
+            if (++digit[j] < f.card[j]) {break;}
+            ix -= sx[j] * f.card[j];
+            iy -= sy[j] * f.card[j];
+            digit[j] = 0;
+        }
+    }
+    return f;
+}
+/*
+ * sumOut()
+ * Purpose:     sums a variable out of a symbolic factor
+ * Parameters:  builder, factor and variable
+ * Returns:     factor over the other variables
+ */
+static Symbolic sumOut(Builder &b, const Symbolic &x, int var)
+{
+    Symbolic f;
+    int at = find(x.vars.begin(), x.vars.end(), var) - x.vars.begin();
+    for (size_t i = 0; i < x.vars.size(); i++) {
+        if ((int)i == at) {continue;}
+        f.vars.push_back(x.vars[i]);
+        f.card.push_back(x.card[i]);
+    }
+    int total = 1;
+    for (size_t i = 0; i < f.card.size(); i++) {
+        total *= f.card[i];
+    }
+    int step = x.strides(vector<int>(1, var))[0];
+    vector<int> sx = x.strides(f.vars);
+    vector<int> digit(f.vars.size(), 0);
+    vector<int32_t> terms(x.card[at]);
+    int base = 0;
+    for (int i = 0; i < total; i++) {
+        for (int k = 0; k < x.card[at]; k++) {
+            terms[k] = x.nodes[base + k * step];
+        }
+        f.nodes.push_back(b.add(terms));
+        for (int j = f.vars.size() - 1; j >= 0; j--) {
+            base += sx[j];
+            if (++digit[j] < f.card[j]) {break;}
+            base -= sx[j] * f.card[j];
+            digit[j] = 0;
+        }
+    }
+    return f;
+}
+
+/*
+ * constructor
+ * Purpose:     loads the circuit from file if it was compiled from this
+ *              model, otherwise compiles it (and saves it there if a file
+ *              is given)
+ */
+ArithmeticCircuit::ArithmeticCircuit(const Model &m, Heuristic h,
+                                     const string &file)
+    : Engine(m)
+{
+    valueStart.assign(1, 0);
+    for (int v = 0; v < model.numVars(); v++) {
+        valueStart.push_back(valueStart.back() + model.getNumVal(v));
+    }
+    if (file.empty() or !load(file)) {
+        compile(h);
+        if (!file.empty()) {save(file);}
+    }
+    for (size_t i = 0; i < constants.size(); i++) {
+        logConstants.push_back(logOf(constants[i]));
+    }
+}
+/*
+ * compile()
+ * Purpose:     builds the circuit by eliminating every variable, in the
+ *              heuristic's order, from factors whose entries are the
+ *              products of a CPT entry and its variable's indicator
+ * Parameters:  elimination ordering heuristic
+ * Returns:     none
+ */
+void ArithmeticCircuit::compile(Heuristic h)
+{
+    int n = model.numVars();
+    kind.clear();
+    arg.clear();
+    childStart.clear();
+    children.clear();
+    constants.clear();
+    Builder b = {kind, arg, childStart, children, constants,
+                 map<double, int32_t>()};
+    b.constant(0);
+    b.constant(1);
+    vector<int32_t> indicator(valueStart.back());
+    for (int k = 0; k < valueStart.back(); k++) {
+        indicator[k] = b.node(INDICATOR, k);
+    }
+
+    vector<bool> all(n, true);
+    vector<int> order = eliminationOrder(model, all, all, h);
+    vector<int> position(n);
+    for (int i = 0; i < n; i++) {
+        position[order[i]] = i;
+    }
+    vector<vector<Symbolic>> buckets(n + 1);
+    for (int v = 0; v < n; v++) {
+        Symbolic f;
+        int total = model.getNumVal(v);
+        for (int i = 0; i < model.getNumParents(v); i++) {
+            f.vars.push_back(model.getParents(v)[i]);
+            f.card.push_back(model.getNumVal(model.getParents(v)[i]));
+            total *= f.card.back();
+        }
+        f.vars.push_back(v);
+        f.card.push_back(model.getNumVal(v));
+        const double *cpt = model.getCPT(v);
+        for (int i = 0; i < total; i++) {
+            int x = i % model.getNumVal(v);
+            f.nodes.push_back(b.multiply(b.constant(cpt[i]),
+                                         indicator[valueStart[v] + x]));
+        }
+        int first = n;
+        for (size_t i = 0; i < f.vars.size(); i++) {
+            first = min(first, position[f.vars[i]]);
+        }
+        buckets[first].push_back(f);
+    }
+    for (int i = 0; i < n; i++) {
+        if (buckets[i].empty()) {continue;}
+        Symbolic f = buckets[i][0];
+        for (size_t j = 1; j < buckets[i].size(); j++) {
+            f = product(b, f, buckets[i][j]);
+        }
+        buckets[i].clear();
+        f = sumOut(b, f, order[i]);
+        int first = n;
+        for (size_t j = 0; j < f.vars.size(); j++) {
+            first = min(first, position[f.vars[j]]);
+        }
+        buckets[first].push_back(f);
+    }
+    root = ONE; // what is left are numbers, one per connected part
+    for (size_t i = 0; i < buckets[n].size(); i++) {
+        root = b.multiply(root, buckets[n][i].nodes[0]);
+    }
+    childStart.push_back(children.size());
+}
+/*
+ * evaluate()
+ * Purpose:     runs the upward and downward passes for the evidence,
+ *              unless the context already holds them
+ * Parameters:  context and evidence
+ * Returns:     none
+ */
+void ArithmeticCircuit::evaluate(Context &ctx,
+                                 const vector<int> &evidence) const
+{
+    if (ctx.evaluated and ctx.evidence == evidence) {return;}
+    if (logSpace) {
+        evaluateLog(ctx, evidence);
+        return;
+    }
+    int n = model.numVars();
+    ctx.lambda.assign(valueStart.back(), 1);
+    for (int v = 0; v < n; v++) {
+        if (evidence[v] == NONE) {continue;}
+        for (int x = 0; x < model.getNumVal(v); x++) {
+            ctx.lambda[valueStart[v] + x] = (x == evidence[v]);
+        }
+    }
+    size_t size = kind.size();
+    vector<double> &value = ctx.value;
+    vector<double> &deriv = ctx.deriv;
+    value.resize(size);
+    for (size_t i = 0; i < size; i++) { // children come first
+        const int32_t *c = &children[childStart[i]];
+        switch (kind[i]) {
+        case CONSTANT:
+            value[i] = constants[arg[i]];
+            break;
+        case INDICATOR:
+            value[i] = ctx.lambda[arg[i]];
+            break;
+        case MUL:
+            value[i] = value[c[0]] * value[c[1]];
+            break;
+        default: {
+            double sum = 0;
+            for (int j = 0; j < childStart[i + 1] - childStart[i]; j++) {
+                sum += value[c[j]];
+            }
+            value[i] = sum;
+        }
+        }
+    }
+    deriv.assign(size, 0);
+    deriv[root] = 1;
+    fill(ctx.lambda.begin(), ctx.lambda.end(), 0); // now the derivatives
+    for (size_t i = root + 1; i-- > 0;) { // parents come first
+        double d = deriv[i];
+        if (d == 0) {continue;}
+        const int32_t *c = &children[childStart[i]];
+        if (kind[i] == MUL) {
+            deriv[c[0]] += d * value[c[1]];
+            deriv[c[1]] += d * value[c[0]];
+        } else if (kind[i] == ADD) {
+            for (int j = 0; j < childStart[i + 1] - childStart[i]; j++) {
+                deriv[c[j]] += d;
+            }
+        } else if (kind[i] == INDICATOR) {
+            ctx.lambda[arg[i]] = d;
+        }
+    }
+    STAT_COUNT(FACTOR_ENTRIES, 2 * size);
+    ctx.evidence = evidence;
+    ctx.evaluated = true;
+}
+/*
+ * evaluateLog()
+ * Purpose:     evaluate() on the logs of every value and derivative, so
+ *              deep networks do not underflow
+ * Parameters:  context and evidence
+ * Returns:     none; the context's derivatives are logs
+ */
+void ArithmeticCircuit::evaluateLog(Context &ctx,
+                                    const vector<int> &evidence) const
+{
+    int n = model.numVars();
+    ctx.lambda.assign(valueStart.back(), 0);
+    for (int v = 0; v < n; v++) {
+        if (evidence[v] == NONE) {continue;}
+        for (int x = 0; x < model.getNumVal(v); x++) {
+            ctx.lambda[valueStart[v] + x] = x == evidence[v] ? 0 : LOG_ZERO;
+        }
+    }
+    size_t size = kind.size();
+    vector<double> &value = ctx.value;
+    vector<double> &deriv = ctx.deriv;
+    value.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        const int32_t *c = &children[childStart[i]];
+        switch (kind[i]) {
+        case CONSTANT:
+            value[i] = logConstants[arg[i]];
+            break;
+        case INDICATOR:
+            value[i] = ctx.lambda[arg[i]];
+            break;
+        case MUL:
+            value[i] = logTimes(value[c[0]], value[c[1]]);
+            break;
+        default: {
+            double sum = LOG_ZERO;
+            for (int j = 0; j < childStart[i + 1] - childStart[i]; j++) {
+                sum = logPlus(sum, value[c[j]]);
+            }
+            value[i] = sum;
+        }
+        }
+    }
+    deriv.assign(size, LOG_ZERO);
+    deriv[root] = 0;
+    fill(ctx.lambda.begin(), ctx.lambda.end(), LOG_ZERO);
+    for (size_t i = root + 1; i-- > 0;) {
+        double d = deriv[i];
+        if (d <= LOG_ZERO) {continue;}
+        const int32_t *c = &children[childStart[i]];
+        if (kind[i] == MUL) {
+            deriv[c[0]] = logPlus(deriv[c[0]], logTimes(d, value[c[1]]));
+            deriv[c[1]] = logPlus(deriv[c[1]], logTimes(d, value[c[0]]));
+        } else if (kind[i] == ADD) {
+            for (int j = 0; j < childStart[i + 1] - childStart[i]; j++) {
+                deriv[c[j]] = logPlus(deriv[c[j]], d);
+            }
+        } else if (kind[i] == INDICATOR) {
+            ctx.lambda[arg[i]] = d;
+        }
+    }
+    STAT_COUNT(FACTOR_ENTRIES, 2 * size);
+    ctx.evidence = evidence;
+    ctx.evaluated = true;
+}
+/*
+ * ask()
+ * Purpose:     reads the query's distribution off the derivatives by its
+ *              indicators, evaluating the circuit if the evidence changed
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
+ */
+void ArithmeticCircuit::ask(QueryContext &ctx, int query,
+                            const vector<int> &evidence,
+                            vector<double> &dist) const
+{
+    Context &c = static_cast<Context &>(ctx);
+    evaluate(c, evidence);
+    dist.assign(c.lambda.begin() + valueStart[query],
+                c.lambda.begin() + valueStart[query + 1]);
+    if (logSpace) {logToLinear(dist);}
+}
+/*
+ * askAll()
+ * Purpose:     computes every posterior from one pair of passes
+ * Parameters:  context, evidence and the vectors to fill, one per
+ *              variable
+ * Returns:     none
+ */
+void ArithmeticCircuit::askAll(QueryContext &ctx, const vector<int> &evidence,
+                               vector<vector<double>> &dists) const
+{
+    dists.assign(model.numVars(), vector<double>());
+    for (int v = 0; v < model.numVars(); v++) {
+        if (evidence[v] == NONE) {ask(ctx, v, evidence, dists[v]);}
+    }
+}
+/*
+ * askBatch()
+ * Purpose:     evaluates the circuit for LANES evidence rows at a time,
+ *              reading each row's distribution off its lane
+ * Parameters:  same as Engine::askBatch()
+ * Returns:     none
+ */
+void ArithmeticCircuit::askBatch(QueryContext &ctx, int query,
+                                 const vector<int> &evidence,
+                                 const vector<int> &vars,
+                                 const vector<int> &values, size_t rows,
+                                 vector<double> &dists) const
+{
+    if (logSpace) { // the lanes hold probabilities, so ask row by row
+        Engine::askBatch(ctx, query, evidence, vars, values, rows, dists);
+        return;
+    }
+    Context &c = static_cast<Context &>(ctx);
+    int card = model.getNumVal(query);
+    size_t k = vars.size();
+    dists.assign(rows * card, 0);
+    vector<double> shared(valueStart.back() * LANES, 1); // every row's part
+    for (int v = 0; v < model.numVars(); v++) {
+        if (evidence[v] == NONE or v == query) {continue;}
+        for (int x = 0; x < model.getNumVal(v); x++) {
+            fill(&shared[(valueStart[v] + x) * LANES],
+                 &shared[(valueStart[v] + x) * LANES] + LANES,
+                 x == evidence[v] ? 1.0 : 0.0);
+        }
+    }
+    for (size_t first = 0; first < rows; first += LANES) {
+        c.laneLambda = shared;
+        for (size_t j = 0; j < k; j++) {
+            int v = vars[j];
+            if (v == query) {continue;}
+            for (size_t l = 0; l < LANES; l++) { // spare lanes copy the last
+                int e = values[min(first + l, rows - 1) * k + j];
+                for (int x = 0; x < model.getNumVal(v); x++) {
+                    c.laneLambda[(valueStart[v] + x) * LANES + l] =
+                        e == NONE or e == x;
+                }
+            }
+        }
+        evaluateLanes(c);
+        for (size_t l = 0; l < LANES and first + l < rows; l++) {
+            for (int x = 0; x < card; x++) {
+                dists[(first + l) * card + x] =
+                    c.laneLambda[(valueStart[query] + x) * LANES + l];
+            }
+        }
+    }
+}
+/*
+ * evaluateLanes()
+ * Purpose:     the upward and downward passes of evaluate() on every lane
+ *              of the context's indicators at once
+ * Parameters:  context, its lane indicators set
+ * Returns:     none; the lane indicators become their derivatives
+ */
+void ArithmeticCircuit::evaluateLanes(Context &ctx) const
+{
+    const FactorKernels &kernels = factorKernels();
+    size_t size = kind.size();
+    vector<double> &value = ctx.lanes;
+    vector<double> &deriv = ctx.laneDeriv;
+    vector<double> &lambda = ctx.laneLambda;
+    value.resize(size * LANES);
+    for (size_t i = 0; i < size; i++) {
+        double *out = &value[i * LANES];
+        const int32_t *c = &children[childStart[i]];
+        switch (kind[i]) {
+        case CONSTANT:
+            fill(out, out + LANES, constants[arg[i]]);
+            break;
+        case INDICATOR:
+            copy(&lambda[arg[i] * LANES], &lambda[arg[i] * LANES] + LANES, out);
+            break;
+        case MUL:
+            kernels.multiply(out, &value[c[0] * LANES], &value[c[1] * LANES],
+                             LANES);
+            break;
+        default:
+            copy(&value[c[0] * LANES], &value[c[0] * LANES] + LANES, out);
+            for (int j = 1; j < childStart[i + 1] - childStart[i]; j++) {
+                kernels.add(out, &value[c[j] * LANES], LANES);
+            }
+        }
+    }
+    deriv.assign(size * LANES, 0);
+    fill(&deriv[root * LANES], &deriv[root * LANES] + LANES, 1.0);
+    fill(lambda.begin(), lambda.end(), 0);
+    double product[LANES];
+    for (size_t i = root + 1; i-- > 0;) {
+        const double *d = &deriv[i * LANES];
+        const int32_t *c = &children[childStart[i]];
+        if (kind[i] == MUL) {
+            kernels.multiply(product, d, &value[c[1] * LANES], LANES);
+            kernels.add(&deriv[c[0] * LANES], product, LANES);
+            kernels.multiply(product, d, &value[c[0] * LANES], LANES);
+            kernels.add(&deriv[c[1] * LANES], product, LANES);
+        } else if (kind[i] == ADD) {
+            for (int j = 0; j < childStart[i + 1] - childStart[i]; j++) {
+                kernels.add(&deriv[c[j] * LANES], d, LANES);
+            }
+        } else if (kind[i] == INDICATOR) {
+            copy(d, d + LANES, &lambda[arg[i] * LANES]);
+        }
+    }
+    STAT_COUNT(FACTOR_ENTRIES, 2 * size * LANES);
+}
+/*
+ * save()
+ * Purpose:     writes the circuit, stamped with the model's fingerprint
+ * Parameters:  filename
+ * Returns:     none; exits with an error if it could not be written
+ */
+void ArithmeticCircuit::save(const string &filename) const
+{
+    ofstream outfile(filename, ios::binary);
+    if (!outfile.is_open()) {
+        cerr << "Error: could not open " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    CircuitHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.model = model.fingerprint();
+    h.numNodes = kind.size();
+    h.numChildren = children.size();
+    h.numConstants = constants.size();
+    h.root = root;
+    outfile.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    outfile.write(reinterpret_cast<const char *>(kind.data()),
+                  kind.size() * sizeof(int32_t));
+    outfile.write(reinterpret_cast<const char *>(arg.data()),
+                  arg.size() * sizeof(int32_t));
+    outfile.write(reinterpret_cast<const char *>(childStart.data()),
+                  childStart.size() * sizeof(int32_t));
+    outfile.write(reinterpret_cast<const char *>(children.data()),
+                  children.size() * sizeof(int32_t));
+    outfile.write(reinterpret_cast<const char *>(constants.data()),
+                  constants.size() * sizeof(double));
+    outfile.close();
+    if (!outfile) { // what did get written fails load()'s checks
+        cerr << "Error: could not write " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+}
+/*
+ * load()
+ * Purpose:     reads a saved circuit, checking that it was compiled from
+ *              this model and that every node only refers to earlier ones
+ * Parameters:  filename
+ * Returns:     true if loaded; false leaves the circuit to be compiled
+ */
+bool ArithmeticCircuit::load(const string &filename)
+{
+    ifstream infile(filename, ios::binary);
+    CircuitHeader h;
+    if (!infile.read(reinterpret_cast<char *>(&h), sizeof(h)) or
+        memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 or h.version != VERSION or
+        h.model != model.fingerprint() or h.root < 0 or
+        (uint64_t)h.root >= h.numNodes) {
+        return false;
+    }
+    kind.resize(h.numNodes);
+    arg.resize(h.numNodes);
+    childStart.resize(h.numNodes + 1);
+    children.resize(h.numChildren);
+    constants.resize(h.numConstants);
+    infile.read(reinterpret_cast<char *>(kind.data()),
+                kind.size() * sizeof(int32_t));
+    infile.read(reinterpret_cast<char *>(arg.data()),
+                arg.size() * sizeof(int32_t));
+    infile.read(reinterpret_cast<char *>(childStart.data()),
+                childStart.size() * sizeof(int32_t));
+    infile.read(reinterpret_cast<char *>(children.data()),
+                children.size() * sizeof(int32_t));
+    infile.read(reinterpret_cast<char *>(constants.data()),
+                constants.size() * sizeof(double));
+    bool good = (bool)infile and childStart[0] == 0 and
+                childStart[h.numNodes] == (int64_t)h.numChildren;
+    for (size_t i = 0; good and i < h.numNodes; i++) {
+        int32_t from = childStart[i], to = childStart[i + 1];
+        good = from <= to;
+        for (int32_t j = from; good and j < to; j++) {
+            good = children[j] >= 0 and (size_t)children[j] < i;
+        }
+        if (kind[i] == CONSTANT) {
+            good = good and arg[i] >= 0 and (uint64_t)arg[i] < h.numConstants;
+        } else if (kind[i] == INDICATOR) {
+            good = good and arg[i] >= 0 and arg[i] < valueStart.back();
+        } else if (kind[i] == MUL) {
+            good = good and to - from == 2;
+        } else {
+            good = good and kind[i] == ADD;
+        }
+    }
+    root = h.root;
+    return good;
+}
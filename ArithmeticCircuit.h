@@ -0,0 +1,83 @@
+/*
+ * ArithmeticCircuit.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Inference by compiling the network once into an arithmetic
+ *          circuit: a DAG of sums and products over the CPT entries and
+ *          one indicator per value of each variable, traced from
+ *          eliminating every variable symbolically. Setting the indicators
+ *          that disagree with the evidence to 0 and evaluating the circuit
+ *          bottom up gives P(evidence); one pass back down gives the
+ *          derivative by every indicator, which for a variable that is not
+ *          evidence is P(value, evidence). Either pass is a single sweep
+ *          over flat arrays, so every query costs time linear in the
+ *          circuit, and one pair of passes answers every variable. A
+ *          batch of evidence rows is evaluated several rows at a time,
+ *          each node holding one value per row side by side, so the
+ *          factor kernels work on all the rows at once.
+ *
+ *          In log space (--log) both passes work on the logs of the
+ *          values and a batch is answered a row at a time.
+ *
+ *          A compiled circuit can be saved to a file and loaded again by
+ *          the same model, skipping the compilation.
+ */
+#ifndef _ARITHMETICCIRCUIT_H_
+#define _ARITHMETICCIRCUIT_H_
+
+#include "Engine.h"
+#include "Ordering.h"
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+class ArithmeticCircuit : public Engine {
+public:
+    ArithmeticCircuit(const Model &m, Heuristic h, const string &file = "");
+
+    QueryContext *newContext() const { return new Context(); }
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+    void askAll(QueryContext &ctx, const vector<int> &evidence,
+                vector<vector<double>> &dists) const;
+    void askBatch(QueryContext &ctx, int query, const vector<int> &evidence,
+                  const vector<int> &vars, const vector<int> &values,
+                  size_t rows, vector<double> &dists) const;
+
+    enum Kind { CONSTANT, INDICATOR, ADD, MUL }; // every MUL has 2 children
+
+    size_t numNodes() const { return kind.size(); }
+    size_t numEdges() const { return children.size(); }
+    void save(const string &filename) const;
+    bool load(const string &filename);
+
+private:
+    /* the passes of the last evidence, kept while it does not change */
+    struct Context : public QueryContext {
+        bool evaluated;
+        vector<int> evidence;
+        vector<double> value;  // of each node
+        vector<double> deriv;  // of the root by each node
+        vector<double> lambda; // indicator of each value, then its derivative
+        vector<double> lanes;  // the same three for a batch's rows, one row
+        vector<double> laneDeriv;  // per lane: entry k * LANES + l is
+        vector<double> laneLambda; // node or value k of lane l
+        Context() : evaluated(false) {}
+    };
+
+    vector<int32_t> kind;       // nodes, children before parents
+    vector<int32_t> arg;        // CONSTANT: its constant, INDICATOR: value
+    vector<int32_t> childStart; // children of i: [childStart[i], [i + 1])
+    vector<int32_t> children;
+    vector<double> constants;
+    vector<double> logConstants; // for log space
+    int32_t root;
+    vector<int> valueStart;     // indicator of v = x is valueStart[v] + x
+
+    void compile(Heuristic h);
+    void evaluate(Context &ctx, const vector<int> &evidence) const;
+    void evaluateLog(Context &ctx, const vector<int> &evidence) const;
+    void evaluateLanes(Context &ctx) const;
+};
+#endif
@@ -0,0 +1,310 @@
+/*
+ * BinaryEnumeration.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of BinaryEnumeration class.
+ */
+#include "BinaryEnumeration.h"
+#include <algorithm>
+
+using namespace std;
+
+static const int TASKS_PER_WORKER = 16; // enough tasks to balance the load
+static const int MIN_SPLIT = 12;        // fewer free variables run serially
+// most hidden variables walked exhaustively: 2^30 steps already take
+// seconds, past it the general recursion, which skips branches of
+// probability 0, takes over (the step count would overflow past 62)
+static const int MAX_FREE = 30;
+static const uint64_t REFRESH = 1024;   // steps between exact recomputes
+
+/* pulls the bits under a mask down to the low end, one bit at a time */
+struct PortableBits {
+    static uint64_t extract(uint64_t word, uint64_t mask)
+    {
+        uint64_t result = 0;
+        for (int k = 0; mask != 0; mask &= mask - 1, k++) {
+            if (word & mask & -mask) {result |= uint64_t(1) << k;}
+        }
+        return result;
+    }
+};
+
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#include <immintrin.h>
+#define HAVE_PEXT
+#define BMI2 __attribute__((target("bmi2")))
+
+/* the same in one instruction */
+struct PextBits {
+    BMI2 static uint64_t extract(uint64_t word, uint64_t mask)
+    {
+        return _pext_u64(word, mask);
+    }
+};
+
+/*
+ * hasPext()
+ * Purpose:     tells whether the CPU has BMI2's pext
+ * Parameters:  none
+ * Returns:     true if it does
+ */
+static bool hasPext()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+}
+static const bool PEXT = hasPext();
+#endif
+
+/*
+ * constructor
+ * Purpose:     places the variables in the bitset and lays each CPT out
+ *              by the row index its parents' extracted bits form
+ */
+BinaryEnumeration::BinaryEnumeration(const Model &m, WorkStealingPool *p)
+    : Enumeration(m, p)
+{
+    int n = model.numVars();
+    bit.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        bit[model.getOrder()[i]] = i;
+    }
+    words = (n + 63) / 64;
+    segmentStart.assign(n + 1, 0);
+    tableStart.assign(n + 1, 0);
+    vector<int> assignment(n, 0);
+    for (int v = 0; v < n; v++) {
+        int k = model.getNumParents(v);
+        vector<int> ranked(model.getParents(v), model.getParents(v) + k);
+        sort(ranked.begin(), ranked.end(), [this](int a, int b) {
+            return bit[a] < bit[b];
+        });
+        for (int j = 0; j < k; j++) { // extraction keeps this order
+            int w = bit[ranked[j]] / 64;
+            if (j == 0 or segments.back().word != w) {
+                Segment s = {w, 0, j};
+                segments.push_back(s);
+            }
+            segments.back().mask |= uint64_t(1) << (bit[ranked[j]] % 64);
+        }
+        segmentStart[v + 1] = segments.size();
+        const double *cpt = model.getCPT(v);
+        for (int64_t r = 0; r < (int64_t(1) << k); r++) {
+            for (int j = 0; j < k; j++) {
+                assignment[ranked[j]] = r >> j & 1;
+            }
+            int row = model.getRow(v, assignment.data());
+            table.push_back(cpt[2 * row]);
+            table.push_back(cpt[2 * row + 1]);
+        }
+        tableStart[v + 1] = table.size();
+    }
+}
+/*
+ * applies()
+ * Purpose:     tells whether a model can use this engine
+ * Parameters:  model
+ * Returns:     true if every variable has exactly two values
+ */
+bool BinaryEnumeration::applies(const Model &m)
+{
+    for (int v = 0; v < m.numVars(); v++) {
+        if (m.getNumVal(v) != 2) {return false;}
+    }
+    return m.numVars() > 0;
+}
+/*
+ * ask()
+ * Purpose:     fill distribution table for query variable(before
+ *              normalization) by a Gray-code walk over the hidden
+ *              variables, split into tasks on their top bits
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
+ */
+void BinaryEnumeration::ask(QueryContext &ctx, int query,
+                            const vector<int> &evidence,
+                            vector<double> &dist) const
+{
+    if (logSpace) {
+        Enumeration::ask(ctx, query, evidence, dist);
+        return;
+    }
+    int n = model.numVars();
+    vector<int> pruned = evidence;
+    if (!relevant(query, pruned, ctx.needed)) {
+        dist.assign(2, 0);
+        return;
+    }
+    propagate(query, ctx.needed, pruned); // forced variables need no walk
+    Sweep s;
+    s.needed = ctx.needed;
+    for (int i = n - 1; i >= 0; i--) { // children before parents
+        int v = model.getOrder()[i];
+        if (!s.needed[v]) {continue;}
+        if (pruned[v] == NONE and v != query) {
+            bool barren = true; // its CPT would just sum to 1
+            for (int j = 0; j < model.getNumChildren(v); j++) {
+                if (s.needed[model.getChildren(v)[j]]) {barren = false;}
+            }
+            if (barren) {
+                s.needed[v] = false;
+                continue;
+            }
+        }
+        s.factors.push_back(v);
+        if (pruned[v] == NONE) {s.free.push_back(v);}
+    }
+    if ((int)s.free.size() > MAX_FREE) {
+        Enumeration::ask(ctx, query, evidence, dist);
+        return;
+    }
+    s.bits.assign(words, 0);
+    for (int v = 0; v < n; v++) {
+        if (pruned[v] == 1) { // parents of needed CPTs may not be needed
+            s.bits[bit[v] / 64] |= uint64_t(1) << (bit[v] % 64);
+        }
+    }
+    int fixed = 0; // free variables set per task rather than walked
+    if (pool != NULL and (int)s.free.size() >= MIN_SPLIT) {
+        while ((1 << fixed) < TASKS_PER_WORKER * pool->size() and
+               fixed < (int)s.free.size()) {
+            fixed++;
+        }
+    }
+    vector<double> partial(2 << fixed, 0);
+    if (fixed == 0) {
+        walk(s, query, 0, 0, &partial[0]);
+    } else {
+        WorkStealingPool::Group group;
+        for (uint64_t top = 0; top < (uint64_t(1) << fixed); top++) {
+            pool->spawn(group, [this, &s, &partial, query, fixed, top]() {
+                walk(s, query, fixed, top, &partial[2 * top]);
+            });
+        }
+        pool->wait(group);
+    }
+    // added in task order, so the result does not depend on the threads
+    dist.assign(2, 0);
+    for (size_t i = 0; i < partial.size(); i++) {
+        dist[i % 2] += partial[i];
+    }
+}
+/*
+ * walk()
+ * Purpose:     runs gray() with the fastest bit extraction the CPU has
+ * Parameters:  same as gray()
+ * Returns:     none
+ */
+void BinaryEnumeration::walk(const Sweep &s, int query, int fixed,
+                             uint64_t top, double dist[2]) const
+{
+#ifdef HAVE_PEXT
+    if (PEXT) {
+        grayPext(s, query, fixed, top, dist);
+        return;
+    }
+#endif
+    gray<PortableBits>(s, query, fixed, top, dist);
+}
+#ifdef HAVE_PEXT
+/*
+ * grayPext()
+ * Purpose:     gray() with pext, compiled for BMI2 with everything it
+ *              calls inlined
+ */
+__attribute__((target("bmi2"), flatten))
+void BinaryEnumeration::grayPext(const Sweep &s, int query, int fixed,
+                                 uint64_t top, double dist[2]) const
+{
+    gray<PextBits>(s, query, fixed, top, dist);
+}
+#else
+void BinaryEnumeration::grayPext(const Sweep &s, int query, int fixed,
+                                 uint64_t top, double dist[2]) const
+{
+    gray<PortableBits>(s, query, fixed, top, dist);
+}
+#endif
+/*
+ * gray()
+ * Purpose:     adds up the joint probability of every assignment of the
+ *              walked free variables, the last fixed ones set from top.
+ *              Each step flips one variable, so only its own and its
+ *              children's entries change; the product is updated by
+ *              dividing the old entries out (entries of 0 are counted
+ *              instead) and recomputed now and then so rounding cannot
+ *              build up.
+ * Parameters:  sweep, query variable, how many free variables are fixed,
+ *              their values (a bit each) and the sums to add to, by the
+ *              query's value
+ * Returns:     none
+ */
+template <class Bits>
+void BinaryEnumeration::gray(const Sweep &s, int query, int fixed,
+                             uint64_t top, double dist[2]) const
+{
+    vector<uint64_t> bits = s.bits;
+    int walked = s.free.size() - fixed;
+    for (int j = 0; j < fixed; j++) {
+        int b = bit[s.free[walked + j]];
+        if (top >> j & 1) {bits[b / 64] |= uint64_t(1) << (b % 64);}
+    }
+    vector<double> entry(model.numVars(), 0); // current one of each factor
+    int zeros = 0;
+    double product = 1;
+    auto lookup = [&](int v) {
+        uint64_t row = 0;
+        for (int i = segmentStart[v]; i < segmentStart[v + 1]; i++) {
+            const Segment &g = segments[i];
+            row |= Bits::extract(bits[g.word], g.mask) << g.shift;
+        }
+        int b = bit[v];
+        return table[tableStart[v] + 2 * row + (bits[b / 64] >> (b % 64) & 1)];
+    };
+    auto refresh = [&]() {
+        zeros = 0;
+        product = 1;
+        for (size_t i = 0; i < s.factors.size(); i++) {
+            int v = s.factors[i];
+            entry[v] = lookup(v);
+            if (entry[v] == 0) {
+                zeros++;
+            } else {
+                product *= entry[v];
+            }
+        }
+    };
+    auto update = [&](int v) {
+        double now = lookup(v);
+        if (entry[v] == 0) {
+            zeros--;
+        } else {
+            product /= entry[v];
+        }
+        if (now == 0) {
+            zeros++;
+        } else {
+            product *= now;
+        }
+        entry[v] = now;
+    };
+    int q = bit[query];
+    refresh();
+    dist[bits[q / 64] >> (q % 64) & 1] += zeros == 0 ? product : 0;
+    uint64_t steps = uint64_t(1) << walked;
+    STAT_COUNT(SUMMATION_BRANCHES, steps);
+    for (uint64_t step = 1; step < steps; step++) {
+        int x = s.free[__builtin_ctzll(step)]; // the bit Gray code flips
+        bits[bit[x] / 64] ^= uint64_t(1) << (bit[x] % 64);
+        if (step % REFRESH == 0) {
+            refresh();
+        } else {
+            update(x);
+            for (int j = 0; j < model.getNumChildren(x); j++) {
+                int c = model.getChildren(x)[j];
+                if (s.needed[c]) {update(c);}
+            }
+        }
+        dist[bits[q / 64] >> (q % 64) & 1] += zeros == 0 ? product : 0;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * BinaryEnumeration.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Enumeration specialized for networks whose variables all have
+ *          two values. The assignment is a bitset, one bit per variable
+ *          in topological order, and each CPT is re-laid out so that the
+ *          parents' bits, extracted from it with one pext per 64-bit word,
+ *          index its rows directly. The hidden variables are walked in
+ *          Gray-code order: each step flips one of them, so only the CPT
+ *          entries of that variable and its children are looked up again.
+ *          Queries it cannot help with (log space, or more than 30 hidden
+ *          variables, whose 2^n steps would never finish) go to the
+ *          general recursion, which at least skips branches of
+ *          probability 0.
+ */
+#ifndef _BINARYENUMERATION_H_
+#define _BINARYENUMERATION_H_
+
+#include "Enumeration.h"
+#include <stdint.h>
+
+using namespace std;
+
+class BinaryEnumeration : public Enumeration {
+public:
+    BinaryEnumeration(const Model &m, WorkStealingPool *p = NULL);
+
+    static bool applies(const Model &m);
+
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+
+private:
+    /* the parents' bits of a variable that lie in one word of the bitset */
+    struct Segment {
+        int word;
+        uint64_t mask;
+        int shift;    // where they go in the row index
+    };
+    /* one query's walk over the hidden variables */
+    struct Sweep {
+        vector<bool> needed;   // less the barren hidden variables
+        vector<int> free;      // hidden variables, the query included
+        vector<int> factors;   // variables whose CPT entries multiply
+        vector<uint64_t> bits; // evidence, and every free variable at 0
+    };
+
+    vector<int> bit;              // position of each variable in the bitset
+    int words;
+    vector<int> segmentStart;     // segments of v: [segmentStart[v], [v + 1])
+    vector<Segment> segments;
+    vector<int64_t> tableStart;   // table of v: P(v = x | row r) at
+    vector<double> table;         // tableStart[v] + 2 * r + x
+
+    void walk(const Sweep &s, int query, int fixed, uint64_t top,
+              double dist[2]) const;
+    template <class Bits>
+    void gray(const Sweep &s, int query, int fixed, uint64_t top,
+              double dist[2]) const;
+    void grayPext(const Sweep &s, int query, int fixed, uint64_t top,
+                  double dist[2]) const;
+};
+#endif
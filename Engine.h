@@ -0,0 +1,180 @@
+/*
+ * Engine.h
+ * by: Valerie Zhang
+ *
+ * Purpose: The Engine class is the interface shared by the inference
+ *          algorithms. Each engine answers a query on a compiled Model.
+ *
+ *          Neither the Model nor an engine changes once built: everything a
+ *          query writes lives in a QueryContext the caller passes in, so
+ *          any number of threads can ask one engine at once, each with a
+ *          context of its own, without locks or copies of the network.
+ */
+#ifndef _ENGINE_H_
+#define _ENGINE_H_
+
+#include "Model.h"
+#include "Relevance.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* the state of one thread's queries; engines that keep work from one query
+   to the next derive their own */
+class QueryContext {
+public:
+    virtual ~QueryContext() {}
+
+    /*
+     * getError()
+     * Purpose:     standard error of each probability in the last estimate
+     *              of a variable's (normalized) distribution
+     * Parameters:  variable
+     * Returns:     the errors, empty for exact engines
+     */
+    const vector<double> &getError(int var) const
+    {
+        static const vector<double> none;
+        return (size_t)var < errors.size() ? errors[var] : none;
+    }
+
+    vector<bool> needed;           // variables the current query depends on
+    vector<vector<double>> errors; // per variable, set by sampling engines
+    string warning;                // why the last estimate may be off, if so
+};
+
+class Engine {
+public:
+    Engine(const Model &m) : model(m), prune(true), logSpace(false) {}
+    virtual ~Engine() {}
+
+    void setPrune(bool on) { prune = on; }
+    void setLogSpace(bool on) { logSpace = on; }
+
+    /*
+     * newContext()
+     * Purpose:     makes a context to ask this engine with
+     * Parameters:  none
+     * Returns:     new context, owned by the caller
+     */
+    virtual QueryContext *newContext() const { return new QueryContext(); }
+    /*
+     * ask()
+     * Purpose:     computes the distribution of the query variable
+     * Parameters:  context made by this engine, query variable, evidence
+     *              (a value ID or NONE for every variable) and the vector
+     *              to fill
+     * Returns:     none; dist[i] is proportional to P(query = i, evidence)
+     */
+    virtual void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+                     vector<double> &dist) const = 0;
+    /*
+     * askAll()
+     * Purpose:     computes the distribution of every variable that is not
+     *              evidence; engines that can share work override this
+     * Parameters:  context, evidence and the vectors to fill, one per
+     *              variable (left empty for evidence variables)
+     * Returns:     none
+     */
+    virtual void askAll(QueryContext &ctx, const vector<int> &evidence,
+                        vector<vector<double>> &dists) const
+    {
+        dists.assign(model.numVars(), vector<double>());
+        for (int v = 0; v < model.numVars(); v++) {
+            if (evidence[v] == NONE) {ask(ctx, v, evidence, dists[v]);}
+        }
+    }
+
+    /*
+     * askBatch()
+     * Purpose:     computes the query's distribution under many evidence
+     *              rows that each set the same variables; engines that can
+     *              share the work between rows override this
+     * Parameters:  context, query variable, evidence every row shares,
+     *              the variables the rows set, their values (row after
+     *              row, NONE to leave one unset), number of rows, and the
+     *              vector to fill with the distributions, row after row
+     * Returns:     none; each row's part is as ask() would fill it
+     */
+    virtual void askBatch(QueryContext &ctx, int query,
+                          const vector<int> &evidence, const vector<int> &vars,
+                          const vector<int> &values, size_t rows,
+                          vector<double> &dists) const
+    {
+        int card = model.getNumVal(query);
+        dists.assign(rows * card, 0);
+        vector<int> row = evidence;
+        vector<double> dist;
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t j = 0; j < vars.size(); j++) {
+                row[vars[j]] = values[r * vars.size() + j];
+            }
+            row[query] = NONE;
+            ask(ctx, query, row, dist);
+            copy(dist.begin(), dist.end(), dists.begin() + r * card);
+        }
+    }
+
+    /*
+     * exact()
+     * Purpose:     tells whether answers are exact; estimates are not
+     *              cached and are printed with their standard errors
+     * Parameters:  none
+     * Returns:     true unless the engine samples
+     */
+    virtual bool exact() const { return true; }
+
+protected:
+    const Model &model;
+    bool prune;    // skip the parts of the network a query does not need
+    bool logSpace; // keep products from underflowing on deep networks
+
+    /*
+     * relevant()
+     * Purpose:     drops d-separated evidence and marks the variables whose
+     *              CPTs the query needs (all of them if pruning is off),
+     *              unless the evidence turns out to be impossible
+     * Parameters:  query variable, evidence to prune and vector to fill
+     * Returns:     false if the evidence is impossible: the query's
+     *              distribution is all 0, whether pruning is on or off
+     */
+    bool relevant(int query, vector<int> &evidence, vector<bool> &needed) const
+    {
+        STAT_TIMER(EVIDENCE);
+        if (!possibleEvidence(model, evidence)) {return false;}
+        if (prune) {
+            relevantNetwork(model, query, evidence, needed);
+        } else {
+            needed.assign(model.numVars(), true);
+        }
+        return true;
+    }
+    /*
+     * propagate()
+     * Purpose:     unit propagation over deterministic CPT rows: in
+     *              topological order, fixes each hidden variable whose
+     *              assigned parents force its value, as if it were
+     *              observed, since its other values have probability 0
+     * Parameters:  query variable (never fixed), variables the query
+     *              needs and the assignment to extend
+     * Returns:     none
+     */
+    void propagate(int query, const vector<bool> &needed,
+                   vector<int> &assignment) const
+    {
+        for (int i = 0; i < model.numVars(); i++) {
+            int v = model.getOrder()[i];
+            if (!needed[v] or assignment[v] != NONE or v == query) {continue;}
+            bool ready = true;
+            for (int k = 0; k < model.getNumParents(v) and ready; k++) {
+                ready = assignment[model.getParents(v)[k]] != NONE;
+            }
+            if (!ready) {continue;}
+            assignment[v] = model.getForced(v, assignment.data());
+            if (assignment[v] != NONE) {STAT_COUNT(FORCED_VALUES, 1);}
+        }
+    }
+};
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Enumeration.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Enumeration class.
+ */
+#include "Enumeration.h"
+#include "LogSpace.h"
+
+using namespace std;
+
+static const int TASKS_PER_WORKER = 16; // enough tasks to balance the load
+static const int MAX_SPLIT = 16; // most values whose branches become tasks,
+                                 // so their partial sums fit on the stack
+
+/*
+ * constructor
+ */
+Enumeration::Enumeration(const Model &m, WorkStealingPool *p) : Engine(m)
+{
+    pool = p;
+}
+/*
+ * ask()
+ * Purpose:     fill distribution table for query variable(before normalization)
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
+ */
+void Enumeration::ask(QueryContext &ctx, int query,
+                      const vector<int> &evidence, vector<double> &dist) const
+{
+    int card = model.getNumVal(query);
+    dist.assign(card, 0);
+    vector<int> pruned = evidence;
+    vector<bool> &needed = ctx.needed;
+    if (!relevant(query, pruned, needed)) {return;} // dist stays 0
+    if (pool == NULL) {
+        for (int i = 0; i < card; i++) { // for each possible value of query
+            vector<int> assignment = pruned;
+            assignment[query] = i; // adds X = xi to evidence
+            propagate(query, needed, assignment);
+            dist[i] = eAll(needed, 0, assignment, 0); // get P(xi, e)
+        }
+        if (logSpace) {logToLinear(dist);}
+        return;
+    }
+    int budget = TASKS_PER_WORKER * pool->size() / card;
+    WorkStealingPool::Group group;
+    for (int i = 0; i < card; i++) { // one task per value of the query
+        pool->spawn(group, [this, &needed, &pruned, &dist, query, i,
+                            budget]() {
+            vector<int> assignment = pruned;
+            assignment[query] = i;
+            propagate(query, needed, assignment);
+            dist[i] = eAll(needed, 0, assignment, budget);
+        });
+    }
+    pool->wait(group);
+    if (logSpace) {logToLinear(dist);}
+}
+/*
+ * eAll()
+ * Purpose:     calculates P(xi,e) for distribution using the compiled model
+ * Parameters:  variables the query depends on, position in the model's
+ *              topological order, the task's own assignment, and how many
+ *              tasks it may still split into
+ * Returns:     P(xi,e), or its log in log space
+ */
+double Enumeration::eAll(const vector<bool> &needed, int count,
+                         vector<int> &assignment, int budget) const
+{
+    STAT_COUNT(ENUM_CALLS, 1);
+    STAT_DEPTH(count + 1);
+    if (count == model.numVars()) { // reached end of order
+        return logSpace ? 0.0 : 1.0;
+    }
+    int var = model.getOrder()[count]; // get variable
+    if (!needed[var]) { // the query does not depend on its CPT
+        return eAll(needed, count + 1, assignment, budget);
+    }
+    if (assignment[var] != NONE) { // if in evidence
+        double p = model.getProbability(var, assignment.data());
+        if (p == 0) { // nothing below can make the product nonzero
+            return logSpace ? LOG_ZERO : 0.0;
+        }
+        if (logSpace) {
+            return logTimes(logOf(p), eAll(needed, count + 1, assignment,
+                                           budget));
+        }
+        return p * eAll(needed, count + 1, assignment, budget);
+    } else {
+        return summation(needed, var, count, assignment, budget);
+    }
+}
+/*
+ * summation()
+ * Purpose:     calculates summation of probababilities of a variable
+ *              given its parents, splitting the values into parallel
+ *              tasks while the task budget lasts
+ * Parameters:  variables the query depends on, variable whose
+ *              probabilities are being summed, var count, assignment and
+ *              task budget
+ * Returns:     sum, or its log in log space (by log-sum-exp over the
+ *              values)
+ */
+double Enumeration::summation(const vector<bool> &needed, int var, int count,
+                              vector<int> &assignment, int budget) const
+{
+    if (model.getNumChildren(var) == 0) { // its probabilities sum to 1
+        return eAll(needed, count + 1, assignment, budget);
+    }
+    int card = model.getNumVal(var);
+    STAT_COUNT(SUMMATIONS, 1);
+    STAT_COUNT(SUMMATION_BRANCHES, card);
+    if (logSpace) {return logSummation(needed, var, count, assignment, budget);}
+    double sum = 0;
+    if (budget > 1 and card <= MAX_SPLIT) {
+        // each branch gets its own copy of the assignment; the partial sums
+        // are added in value order so the result matches the serial one
+        double partial[MAX_SPLIT] = {0};
+        WorkStealingPool::Group group;
+        for (int i = 0; i < card; i++) {
+            double *out = &partial[i];
+            pool->spawn(group, [this, &needed, &assignment, out, var,
+                                count, i, budget, card]() {
+                vector<int> branch = assignment;
+                branch[var] = i;
+                double p = model.getProbability(var, branch.data());
+                if (p == 0) {
+                    STAT_COUNT(ZERO_BRANCHES, 1);
+                    return; // partial[i] stays 0
+                }
+                *out = p * eAll(needed, count + 1, branch, budget / card);
+            });
+        }
+        pool->wait(group);
+        for (int i = 0; i < card; i++) {
+            sum += partial[i];
+        }
+        return sum;
+    }
+    for (int i = 0; i < card; i++) {
+        assignment[var] = i; // assign value
+        double p = model.getProbability(var, assignment.data());
+        if (p == 0) { // skip the whole branch rather than multiply by 0
+            STAT_COUNT(ZERO_BRANCHES, 1);
+            continue;
+        }
+        sum += p * eAll(needed, count + 1, assignment, 0);
+    }
+    assignment[var] = NONE; // reset value
+    return sum;
+}
+/*
+ * logSummation()
+ * Purpose:     summation() in log space: the log of each value's term,
+ *              added up by log-sum-exp as they come
+ * Parameters:  same as summation()
+ * Returns:     log of the sum
+ */
+double Enumeration::logSummation(const vector<bool> &needed, int var,
+                                 int count, vector<int> &assignment,
+                                 int budget) const
+{
+    int card = model.getNumVal(var);
+    LogSum sum;
+    if (budget > 1 and card <= MAX_SPLIT) {
+        double terms[MAX_SPLIT];
+        WorkStealingPool::Group group;
+        for (int i = 0; i < card; i++) {
+            double *out = &terms[i];
+            pool->spawn(group, [this, &needed, &assignment, out, var,
+                                count, i, budget, card]() {
+                vector<int> branch = assignment;
+                branch[var] = i;
+                double p = model.getProbability(var, branch.data());
+                *out = p == 0 ? LOG_ZERO :
+                       logTimes(log(p), eAll(needed, count + 1, branch,
+                                             budget / card));
+            });
+        }
+        pool->wait(group);
+        for (int i = 0; i < card; i++) {
+            sum.add(terms[i]);
+        }
+        return sum.value();
+    }
+    for (int i = 0; i < card; i++) {
+        assignment[var] = i;
+        double p = model.getProbability(var, assignment.data());
+        if (p == 0) {continue;}
+        sum.add(logTimes(log(p), eAll(needed, count + 1, assignment, 0)));
+    }
+    assignment[var] = NONE;
+    return sum.value();
+}
@@ -0,0 +1,39 @@
+/*
+ * Enumeration.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Enumerative inference. Sums the full joint over every hidden
+ *          variable, walking the model in topological order. With a
+ *          WorkStealingPool, the branches near the top of the recursion
+ *          run as parallel tasks. In log space every product becomes
+ *          a sum of logs and every summation a log-sum-exp, so deep
+ *          networks do not underflow.
+ */
+#ifndef _ENUMERATION_H_
+#define _ENUMERATION_H_
+
+#include "Engine.h"
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+class Enumeration : public Engine {
+public:
+    Enumeration(const Model &m, WorkStealingPool *p = NULL);
+
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+
+protected:
+    WorkStealingPool *pool; // NULL to run serially
+
+private:
+
+    double eAll(const vector<bool> &needed, int count,
+                vector<int> &assignment, int budget) const;
+    double summation(const vector<bool> &needed, int var, int count,
+                     vector<int> &assignment, int budget) const;
+    double logSummation(const vector<bool> &needed, int var, int count,
+                        vector<int> &assignment, int budget) const;
+};
+#endif
@@ -0,0 +1,391 @@
+/*
+ * Factor.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Factor class. Factors are multiplied
+ *          together and summed over by the factor-based engines.
+ */
+#include "Factor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static const int SHORT_RUN = 8; // runs shorter than this skip the kernels
+
+/*
+ * default constructor: a scalar factor holding 1
+ */
+Factor::Factor()
+{
+    values.push_back(1.0);
+}
+/*
+ * secondary constructor: a factor of zeros over the given variables
+ */
+Factor::Factor(const vector<int> &v, const vector<int> &c)
+{
+    vars = v;
+    card = c;
+    int total = 1;
+    for (size_t i = 0; i < card.size(); i++) {
+        total *= card[i];
+    }
+    values.assign(total, 0);
+}
+/*
+ * CPT constructor: the CPT of var as a factor over its parents and itself
+ */
+Factor::Factor(const Model &m, int var)
+{
+    const int *parents = m.getParents(var);
+    for (int i = 0; i < m.getNumParents(var); i++) {
+        vars.push_back(parents[i]);
+        card.push_back(m.getNumVal(parents[i]));
+    }
+    vars.push_back(var);
+    card.push_back(m.getNumVal(var));
+    int total = 1;
+    for (size_t i = 0; i < card.size(); i++) {
+        total *= card[i];
+    }
+    const double *cpt = m.getCPT(var); // same layout, so copy it as is
+    values.assign(cpt, cpt + total);
+}
+/*
+ * numVars()
+ * Purpose:     get number of variables in factor
+ * Parameters:  none
+ * Returns:     number of variables
+ */
+int Factor::numVars() const
+{
+    return vars.size();
+}
+/*
+ * getVar()
+ * Purpose:     get variable at position i
+ * Parameters:  position
+ * Returns:     variable ID
+ */
+int Factor::getVar(int i) const
+{
+    return vars[i];
+}
+/*
+ * getCard()
+ * Purpose:     get number of values of the variable at position i
+ * Parameters:  position
+ * Returns:     number of values
+ */
+int Factor::getCard(int i) const
+{
+    return card[i];
+}
+/*
+ * find()
+ * Purpose:     get position of a variable in the factor
+ * Parameters:  variable ID
+ * Returns:     position, or NONE if not in factor
+ */
+int Factor::find(int var) const
+{
+    for (size_t i = 0; i < vars.size(); i++) {
+        if (vars[i] == var) {return i;}
+    }
+    return NONE;
+}
+/*
+ * contains()
+ * Purpose:     determines if variable is in factor
+ * Parameters:  variable ID
+ * Returns:     true if in factor, false if not
+ */
+bool Factor::contains(int var) const
+{
+    return find(var) != NONE;
+}
+/*
+ * size()
+ * Purpose:     get number of entries
+ * Parameters:  none
+ * Returns:     number of entries
+ */
+int Factor::size() const
+{
+    return values.size();
+}
+/*
+ * getValue()
+ * Purpose:     get entry at flat index
+ * Parameters:  index
+ * Returns:     entry
+ */
+double Factor::getValue(int i) const
+{
+    return values[i];
+}
+/*
+ * setValue()
+ * Purpose:     set entry at flat index
+ * Parameters:  index and entry
+ * Returns:     none
+ */
+void Factor::setValue(int i, double value)
+{
+    values[i] = value;
+}
+/*
+ * rescale()
+ * Purpose:     divides every entry by the largest, so a long chain of
+ *              products keeps its entries near 1 instead of underflowing
+ * Parameters:  none
+ * Returns:     log of the entry divided by, 0 if every entry is 0
+ */
+double Factor::rescale()
+{
+    const FactorKernels &kernels = factorKernels();
+    double top = kernels.largest(values.data(), values.size());
+    if (top <= 0) {return 0;}
+    kernels.scale(values.data(), values.data(), 1 / top, values.size());
+    return log(top);
+}
+/*
+ * strides()
+ * Purpose:     finds the stride in this factor of each variable in a list
+ * Parameters:  list of variables and vector to fill (0 when a variable is
+ *              not in this factor)
+ * Returns:     none
+ */
+void Factor::strides(const vector<int> &over, vector<int> &result) const
+{
+    result.assign(over.size(), 0);
+    int stride = 1;
+    for (int i = vars.size() - 1; i >= 0; i--) {
+        for (size_t j = 0; j < over.size(); j++) {
+            if (over[j] == vars[i]) {result[j] = stride;}
+        }
+        stride *= card[i];
+    }
+}
+/*
+ * product()
+ * Purpose:     multiplies two factors
+ * Parameters:  other factor
+ * Returns:     factor over the union of both factors' variables
+ *
+ * The larger factor's variables go last, so its entries are read in order
+ * and the trailing dimensions merge into long runs for the kernels.
+ */
+Factor Factor::product(const Factor &other) const
+{
+    const Factor &big = size() >= other.size() ? *this : other;
+    const Factor &small = (&big == this) ? other : *this;
+    vector<int> v, c;
+    for (int i = 0; i < small.numVars(); i++) {
+        if (!big.contains(small.vars[i])) {
+            v.push_back(small.vars[i]);
+            c.push_back(small.card[i]);
+        }
+    }
+    v.insert(v.end(), big.vars.begin(), big.vars.end());
+    c.insert(c.end(), big.card.begin(), big.card.end());
+    Factor result(v, c);
+    STAT_COUNT(FACTOR_OPS, 1);
+    STAT_COUNT(FACTOR_ENTRIES, result.size());
+    if (v.empty()) {
+        result.values[0] = values[0] * other.values[0];
+        return result;
+    }
+    vector<int> sa, sb;
+    big.strides(v, sa);
+    small.strides(v, sb);
+    // merge the innermost dimensions while the small factor steps through
+    // them evenly (the big one always does)
+    int k = v.size() - 1;
+    int run = c[k];
+    int rb = sb[k];
+    for (k--; k >= 0 and sa[k] == run and sb[k] == rb * run; k--) {
+        run *= c[k];
+    }
+    const FactorKernels &kernels = factorKernels();
+    vector<int> digit(k + 1, 0);
+    int ia = 0, ib = 0;
+    for (int j = 0; j < result.size(); j += run) {
+        double *out = &result.values[j];
+        const double *a = &big.values[ia];
+        const double *b = &small.values[ib];
+        if (run < SHORT_RUN) {
+            for (int t = 0; t < run; t++) {
+                out[t] = a[t] * b[t * rb];
+            }
+        } else if (rb == 1) {
+            kernels.multiply(out, a, b, run);
+        } else if (rb == 0) {
+            if (*b != 0) {kernels.scale(out, a, *b, run);} // else stays 0
+        } else {
+            for (int t = 0; t < run; t++) {
+                out[t] = a[t] * b[t * rb];
+            }
+        }
+        for (int d = k; d >= 0; d--) { // next run
+            digit[d]++;
+            ia += sa[d];
+            ib += sb[d];
+            if (digit[d] < c[d]) {break;}
+            ia -= sa[d] * c[d];
+            ib -= sb[d] * c[d];
+            digit[d] = 0;
+        }
+    }
+    return result;
+}
+/*
+ * sumOut()
+ * Purpose:     sums a variable out of the factor
+ * Parameters:  variable ID
+ * Returns:     factor over the remaining variables
+ */
+Factor Factor::sumOut(int var) const
+{
+    return eliminate(var, false);
+}
+/*
+ * maxOut()
+ * Purpose:     maximizes a variable out of the factor
+ * Parameters:  variable ID
+ * Returns:     factor over the remaining variables
+ */
+Factor Factor::maxOut(int var) const
+{
+    return eliminate(var, true);
+}
+/*
+ * eliminate()
+ * Purpose:     sums or maximizes a variable out of the factor. The entries
+ *              form [before][var][after] blocks, so each block of results
+ *              is a run-wise sum or maximum of the var slices.
+ * Parameters:  variable ID and whether to maximize
+ * Returns:     factor over the remaining variables
+ */
+Factor Factor::eliminate(int var, bool maximize) const
+{
+    int p = find(var);
+    if (p == NONE) {return *this;}
+    vector<int> v, c;
+    int outer = 1, inner = 1;
+    for (size_t i = 0; i < vars.size(); i++) {
+        if ((int)i == p) {continue;}
+        v.push_back(vars[i]);
+        c.push_back(card[i]);
+        ((int)i < p ? outer : inner) *= card[i];
+    }
+    Factor result(v, c);
+    STAT_COUNT(FACTOR_OPS, 1);
+    STAT_COUNT(FACTOR_ENTRIES, result.size());
+    const FactorKernels &kernels = factorKernels();
+    int cp = card[p];
+    for (int o = 0; o < outer; o++) {
+        double *out = &result.values[o * inner];
+        const double *in = &values[o * cp * inner];
+        if (inner == 1 and cp < SHORT_RUN) { // too short for a kernel call
+            double r = in[0];
+            for (int x = 1; x < cp; x++) {
+                r = maximize ? max(r, in[x]) : r + in[x];
+            }
+            *out = r;
+            continue;
+        }
+        if (inner == 1) {
+            *out = maximize ? kernels.largest(in, cp) : kernels.total(in, cp);
+            continue;
+        }
+        memcpy(out, in, inner * sizeof(double));
+        for (int x = 1; x < cp; x++) {
+            if (maximize) {
+                kernels.maximum(out, in + x * inner, inner);
+            } else {
+                kernels.add(out, in + x * inner, inner);
+            }
+        }
+    }
+    return result;
+}
+/*
+ * marginal()
+ * Purpose:     sums out every variable that is not in a list
+ * Parameters:  variables to keep
+ * Returns:     factor over the kept variables that are in this factor
+ */
+Factor Factor::marginal(const vector<int> &keep) const
+{
+    Factor result = *this;
+    for (size_t i = 0; i < vars.size(); i++) {
+        bool kept = false;
+        for (size_t j = 0; j < keep.size(); j++) {
+            if (keep[j] == vars[i]) {kept = true;}
+        }
+        if (!kept) {result = result.sumOut(vars[i]);}
+    }
+    return result;
+}
+/*
+ * reduce()
+ * Purpose:     fixes every evidence variable in the factor to its value
+ * Parameters:  evidence (a value ID or NONE for every variable)
+ * Returns:     factor over the variables that are not evidence
+ */
+Factor Factor::reduce(const vector<int> &evidence) const
+{
+    vector<int> v, c;
+    int offset = 0;
+    int stride = 1;
+    for (int i = vars.size() - 1; i >= 0; i--) {
+        if (evidence[vars[i]] != NONE) {
+            offset += evidence[vars[i]] * stride;
+        }
+        stride *= card[i];
+    }
+    for (size_t i = 0; i < vars.size(); i++) {
+        if (evidence[vars[i]] == NONE) {
+            v.push_back(vars[i]);
+            c.push_back(card[i]);
+        }
+    }
+    if (v.size() == vars.size()) {return *this;}
+    Factor result(v, c);
+    STAT_COUNT(FACTOR_OPS, 1);
+    STAT_COUNT(FACTOR_ENTRIES, result.size());
+    if (v.empty()) {
+        result.values[0] = values[offset];
+        return result;
+    }
+    vector<int> si;
+    strides(v, si);
+    // the kept variables after the last evidence variable form one run
+    int k = v.size() - 1;
+    int run = c[k];
+    int rs = si[k];
+    for (k--; k >= 0 and si[k] == rs * run; k--) {
+        run *= c[k];
+    }
+    const FactorKernels &kernels = factorKernels();
+    vector<int> digit(k + 1, 0);
+    int ii = offset;
+    for (int j = 0; j < result.size(); j += run) {
+        if (rs == 1) {
+            memcpy(&result.values[j], &values[ii], run * sizeof(double));
+        } else {
+            kernels.gather(&result.values[j], &values[ii], rs, run);
+        }
+        for (int d = k; d >= 0; d--) {
+            digit[d]++;
+            ii += si[d];
+            if (digit[d] < c[d]) {break;}
+            ii -= si[d] * c[d];
+            digit[d] = 0;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,48 @@
+/*
+ * Factor.h
+ * by: Valerie Zhang
+ *
+ * Purpose: A Factor is a table of numbers over a set of variables. Entries
+ *          are stored flat, with the last variable changing fastest, the
+ *          same layout the Model uses for its CPTs.
+ */
+#ifndef _FACTOR_H_
+#define _FACTOR_H_
+
+#include "Model.h"
+#include "FactorKernels.h"
+#include <vector>
+
+using namespace std;
+
+class Factor {
+public:
+    Factor();
+    Factor(const vector<int> &vars, const vector<int> &card);
+    Factor(const Model &m, int var);
+
+    int numVars() const;
+    int getVar(int i) const;
+    int getCard(int i) const;
+    int find(int var) const;
+    bool contains(int var) const;
+    int size() const;
+    double getValue(int i) const;
+    void setValue(int i, double value);
+    double rescale();
+
+    Factor product(const Factor &other) const;
+    Factor sumOut(int var) const;
+    Factor maxOut(int var) const;
+    Factor marginal(const vector<int> &keep) const;
+    Factor reduce(const vector<int> &evidence) const;
+
+private:
+    vector<int> vars;
+    vector<int> card;
+    AlignedVector values;
+
+    void strides(const vector<int> &over, vector<int> &result) const;
+    Factor eliminate(int var, bool maximize) const;
+};
+#endif
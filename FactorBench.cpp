@@ -0,0 +1,123 @@
+/*
+ * FactorBench.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: Microbenchmark of the factor operations with each set of
+ *          kernels the CPU supports, on factors the size of the cliques
+ *          and buckets our networks produce. Prints one line per
+ *          operation, size and kernel set, with the speedup over the
+ *          scalar kernels.
+ *
+ *          Build and run with: make factor_bench && ./factor_bench
+ */
+#include "Factor.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+using namespace std;
+
+static const char *LEVELS[] = {"scalar", "avx2", "avx512"};
+static const int NUM_LEVELS = 3;
+
+/*
+ * randomFactor()
+ * Purpose:     makes a factor of pseudo-random entries
+ * Parameters:  variables and their numbers of values
+ * Returns:     factor
+ */
+static Factor randomFactor(const vector<int> &vars, const vector<int> &card)
+{
+    Factor f(vars, card);
+    unsigned x = 12345;
+    for (int i = 0; i < f.size(); i++) {
+        x = x * 1103515245 + 12345;
+        f.setValue(i, (x >> 8) / 16777216.0);
+    }
+    return f;
+}
+/*
+ * timeOp()
+ * Purpose:     times an operation, repeating it for about 0.1 seconds
+ * Parameters:  operation
+ * Returns:     nanoseconds per call
+ */
+static double timeOp(const function<void()> &op)
+{
+    typedef chrono::steady_clock Clock;
+    long calls = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    for (long batch = 1; elapsed < 0.1; batch *= 2) {
+        for (long i = 0; i < batch; i++) {
+            op();
+        }
+        calls += batch;
+        elapsed = chrono::duration<double>(Clock::now() - start).count();
+    }
+    return elapsed * 1e9 / calls;
+}
+/*
+ * bench()
+ * Purpose:     times one operation with every kernel set and prints it
+ * Parameters:  operation name, entries it touches and the operation
+ * Returns:     none
+ */
+static void bench(const char *name, int entries, const function<void()> &op)
+{
+    double scalar = 0;
+    for (int l = 0; l < NUM_LEVELS; l++) {
+        if (!selectFactorKernels(LEVELS[l])) {continue;}
+        double ns = timeOp(op);
+        if (l == 0) {scalar = ns;}
+        printf("%-10s %8d %-7s %12.1f ns %8.3f ns/entry %6.2fx\n", name,
+               entries, LEVELS[l], ns, ns / entries, scalar / ns);
+    }
+    selectFactorKernels("best");
+}
+
+int main()
+{
+    printf("%-10s %8s %-7s %15s %17s %7s\n", "op", "entries", "kernels",
+           "time", "per entry", "speedup");
+    for (int n = 4; n <= 18; n += 2) { // binary cliques of 4 to 18 vars
+        vector<int> vars, card(n, 2);
+        for (int i = 0; i < n; i++) {
+            vars.push_back(i);
+        }
+        Factor clique = randomFactor(vars, card);
+        // a CPT over the clique's last three variables
+        vector<int> family(vars.end() - 3, vars.end());
+        Factor cpt = randomFactor(family, vector<int>(3, 2));
+        // a message over its first half
+        vector<int> sep(vars.begin(), vars.begin() + n / 2);
+        Factor message = randomFactor(sep, vector<int>(n / 2, 2));
+        vector<int> lastEvidence(n, NONE), firstEvidence(n, NONE);
+        lastEvidence[n - 1] = 1;
+        firstEvidence[0] = 1;
+        Factor sink;
+
+        bench("product", clique.size(), [&]() {
+            sink = clique.product(message);
+        });
+        bench("productCPT", clique.size(), [&]() {
+            sink = clique.product(cpt);
+        });
+        bench("sumFirst", clique.size(), [&]() {
+            sink = clique.sumOut(0);
+        });
+        bench("sumLast", clique.size(), [&]() {
+            sink = clique.sumOut(n - 1);
+        });
+        bench("maxFirst", clique.size(), [&]() {
+            sink = clique.maxOut(0);
+        });
+        bench("reduceLast", clique.size(), [&]() {
+            sink = clique.reduce(lastEvidence);
+        });
+        bench("reduceFirst", clique.size(), [&]() {
+            sink = clique.reduce(firstEvidence);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+/*
+ * FactorKernels.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: Scalar, AVX2 and AVX-512 factor kernels and the runtime choice
+ *          between them. The vector versions are compiled for their
+ *          instruction set function by function, so the rest of the
+ *          program still runs on any x86-64 CPU.
+ */
+#include "FactorKernels.h"
+#include <algorithm>
+
+using namespace std;
+
+/********************************************************************\
+*                           scalar kernels                           *
+\********************************************************************/
+
+static void multiplyScalar(double *out, const double *a, const double *b,
+                           size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = a[i] * b[i];
+    }
+}
+static void scaleScalar(double *out, const double *a, double s, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = a[i] * s;
+    }
+}
+static void addScalar(double *sum, const double *a, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        sum[i] += a[i];
+    }
+}
+static void maximumScalar(double *max, const double *a, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] > max[i]) {max[i] = a[i];}
+    }
+}
+static double totalScalar(const double *a, size_t n)
+{
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i];
+    }
+    return sum;
+}
+static double largestScalar(const double *a, size_t n)
+{
+    double best = a[0];
+    for (size_t i = 1; i < n; i++) {
+        if (a[i] > best) {best = a[i];}
+    }
+    return best;
+}
+static void gatherScalar(double *out, const double *a, size_t stride, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = a[i * stride];
+    }
+}
+
+static const FactorKernels SCALAR = {
+    "scalar", multiplyScalar, scaleScalar, addScalar, maximumScalar,
+    totalScalar, largestScalar, gatherScalar
+};
+
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+
+/********************************************************************\
+*                            AVX2 kernels                            *
+\********************************************************************/
+
+#define AVX2 __attribute__((target("avx2,fma")))
+
+AVX2 static void multiplyAVX2(double *out, const double *a, const double *b,
+                              size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i),
+                                                _mm256_loadu_pd(b + i)));
+    }
+    for (; i < n; i++) {
+        out[i] = a[i] * b[i];
+    }
+}
+AVX2 static void scaleAVX2(double *out, const double *a, double s, size_t n)
+{
+    __m256d f = _mm256_set1_pd(s);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), f));
+    }
+    for (; i < n; i++) {
+        out[i] = a[i] * s;
+    }
+}
+AVX2 static void addAVX2(double *sum, const double *a, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(sum + i, _mm256_add_pd(_mm256_loadu_pd(sum + i),
+                                                _mm256_loadu_pd(a + i)));
+    }
+    for (; i < n; i++) {
+        sum[i] += a[i];
+    }
+}
+AVX2 static void maximumAVX2(double *max, const double *a, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(max + i, _mm256_max_pd(_mm256_loadu_pd(max + i),
+                                                _mm256_loadu_pd(a + i)));
+    }
+    for (; i < n; i++) {
+        if (a[i] > max[i]) {max[i] = a[i];}
+    }
+}
+AVX2 static double totalAVX2(const double *a, size_t n)
+{
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // two sums hide the add latency
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+    }
+    s0 = _mm256_add_pd(s0, s1);
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0),
+                           _mm256_extractf128_pd(s0, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+    for (; i < n; i++) {
+        sum += a[i];
+    }
+    return sum;
+}
+AVX2 static double largestAVX2(const double *a, size_t n)
+{
+    if (n < 4) {return largestScalar(a, n);}
+    __m256d m = _mm256_loadu_pd(a);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        m = _mm256_max_pd(m, _mm256_loadu_pd(a + i));
+    }
+    __m128d h = _mm_max_pd(_mm256_castpd256_pd128(m),
+                           _mm256_extractf128_pd(m, 1));
+    double best = _mm_cvtsd_f64(_mm_max_sd(h, _mm_unpackhi_pd(h, h)));
+    for (; i < n; i++) {
+        if (a[i] > best) {best = a[i];}
+    }
+    return best;
+}
+AVX2 static void gatherAVX2(double *out, const double *a, size_t stride,
+                            size_t n)
+{
+    long long s = stride;
+    __m256i index = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+    __m256i step = _mm256_set1_epi64x(4 * s);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_i64gather_pd(a, index, 8));
+        index = _mm256_add_epi64(index, step);
+    }
+    for (; i < n; i++) {
+        out[i] = a[i * stride];
+    }
+}
+
+static const FactorKernels AVX2_KERNELS = {
+    "avx2", multiplyAVX2, scaleAVX2, addAVX2, maximumAVX2, totalAVX2,
+    largestAVX2, gatherAVX2
+};
+
+/********************************************************************\
+*                           AVX-512 kernels                          *
+\********************************************************************/
+
+#define AVX512 __attribute__((target("avx512f")))
+
+AVX512 static void multiplyAVX512(double *out, const double *a,
+                                  const double *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(a + i),
+                                                _mm512_loadu_pd(b + i)));
+    }
+    if (i < n) { // the tail under a mask
+        __mmask8 k = (1u << (n - i)) - 1;
+        _mm512_mask_storeu_pd(out + i, k,
+                              _mm512_mul_pd(_mm512_maskz_loadu_pd(k, a + i),
+                                            _mm512_maskz_loadu_pd(k, b + i)));
+    }
+}
+AVX512 static void scaleAVX512(double *out, const double *a, double s,
+                               size_t n)
+{
+    __m512d f = _mm512_set1_pd(s);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), f));
+    }
+    if (i < n) {
+        __mmask8 k = (1u << (n - i)) - 1;
+        _mm512_mask_storeu_pd(out + i, k,
+                              _mm512_mul_pd(_mm512_maskz_loadu_pd(k, a + i),
+                                            f));
+    }
+}
+AVX512 static void addAVX512(double *sum, const double *a, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(sum + i, _mm512_add_pd(_mm512_loadu_pd(sum + i),
+                                                _mm512_loadu_pd(a + i)));
+    }
+    if (i < n) {
+        __mmask8 k = (1u << (n - i)) - 1;
+        _mm512_mask_storeu_pd(sum + i, k,
+                              _mm512_add_pd(_mm512_maskz_loadu_pd(k, sum + i),
+                                            _mm512_maskz_loadu_pd(k, a + i)));
+    }
+}
+AVX512 static void maximumAVX512(double *max, const double *a, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(max + i, _mm512_max_pd(_mm512_loadu_pd(max + i),
+                                                _mm512_loadu_pd(a + i)));
+    }
+    if (i < n) {
+        __mmask8 k = (1u << (n - i)) - 1;
+        _mm512_mask_storeu_pd(max + i, k,
+                              _mm512_max_pd(_mm512_maskz_loadu_pd(k, max + i),
+                                            _mm512_maskz_loadu_pd(k, a + i)));
+    }
+}
+AVX512 static double totalAVX512(const double *a, size_t n)
+{
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(a + i));
+        s1 = _mm512_add_pd(s1, _mm512_loadu_pd(a + i + 8));
+    }
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(a + i));
+    }
+    if (i < n) {
+        __mmask8 k = (1u << (n - i)) - 1;
+        s1 = _mm512_add_pd(s1, _mm512_maskz_loadu_pd(k, a + i));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+AVX512 static double largestAVX512(const double *a, size_t n)
+{
+    if (n < 8) {return largestScalar(a, n);}
+    __m512d m = _mm512_loadu_pd(a);
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        m = _mm512_max_pd(m, _mm512_loadu_pd(a + i));
+    }
+    double best = _mm512_reduce_max_pd(m);
+    for (; i < n; i++) {
+        if (a[i] > best) {best = a[i];}
+    }
+    return best;
+}
+AVX512 static void gatherAVX512(double *out, const double *a, size_t stride,
+                                size_t n)
+{
+    long long s = stride;
+    __m512i index = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s,
+                                     2 * s, s, 0);
+    __m512i step = _mm512_set1_epi64(8 * s);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_i64gather_pd(index, a, 8));
+        index = _mm512_add_epi64(index, step);
+    }
+    for (; i < n; i++) {
+        out[i] = a[i * stride];
+    }
+}
+
+static const FactorKernels AVX512_KERNELS = {
+    "avx512", multiplyAVX512, scaleAVX512, addAVX512, maximumAVX512,
+    totalAVX512, largestAVX512, gatherAVX512
+};
+#endif
+
+/********************************************************************\
+*                              dispatch                              *
+\********************************************************************/
+
+/*
+ * best()
+ * Purpose:     picks the widest kernels the CPU supports
+ * Parameters:  none
+ * Returns:     kernels
+ */
+static const FactorKernels *best()
+{
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {return &AVX512_KERNELS;}
+    if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma")) {
+        return &AVX2_KERNELS;
+    }
+#endif
+    return &SCALAR;
+}
+
+static const FactorKernels *active = best();
+
+/*
+ * factorKernels()
+ * Purpose:     get the kernels in use
+ * Parameters:  none
+ * Returns:     kernels
+ */
+const FactorKernels &factorKernels()
+{
+    return *active;
+}
+/*
+ * selectFactorKernels()
+ * Purpose:     switches to the named kernels, if the CPU supports them
+ * Parameters:  "scalar", "avx2", "avx512" or "best"
+ * Returns:     true if switched
+ */
+bool selectFactorKernels(const string &name)
+{
+    const FactorKernels *widest = best();
+    if (name == "best") {
+        active = widest;
+        return true;
+    }
+    if (name == "scalar") {
+        active = &SCALAR;
+        return true;
+    }
+#ifdef HAVE_X86_KERNELS
+    if (name == "avx2" and widest != &SCALAR) {
+        active = &AVX2_KERNELS;
+        return true;
+    }
+    if (name == "avx512" and widest == &AVX512_KERNELS) {
+        active = &AVX512_KERNELS;
+        return true;
+    }
+#endif
+    return false;
+}
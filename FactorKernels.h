@@ -0,0 +1,72 @@
+/*
+ * FactorKernels.h
+ * by: Valerie Zhang
+ *
+ * Purpose: The inner loops of the factor operations, over contiguous runs
+ *          of doubles. There is a scalar, an AVX2 and an AVX-512 version
+ *          of each; the best one the CPU supports is picked when the
+ *          program starts. Factor entries live in 64-byte aligned storage
+ *          so whole runs line up with the vector registers.
+ */
+#ifndef _FACTORKERNELS_H_
+#define _FACTORKERNELS_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* one set of kernels; every pointer is filled */
+struct FactorKernels {
+    const char *name;
+    void (*multiply)(double *out, const double *a, const double *b, size_t n);
+    void (*scale)(double *out, const double *a, double s, size_t n);
+    void (*add)(double *sum, const double *a, size_t n);
+    void (*maximum)(double *max, const double *a, size_t n);
+    double (*total)(const double *a, size_t n);
+    double (*largest)(const double *a, size_t n);
+    void (*gather)(double *out, const double *a, size_t stride, size_t n);
+};
+
+const FactorKernels &factorKernels();
+bool selectFactorKernels(const string &name);
+
+/* allocator for storage aligned to a cache line */
+template <class T>
+struct AlignedAllocator {
+    typedef T value_type;
+    static const size_t ALIGNMENT = 64;
+
+    AlignedAllocator() {}
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U> &) {}
+
+    T *allocate(size_t n)
+    {
+        void *p = NULL;
+        if (posix_memalign(&p, ALIGNMENT, n * sizeof(T)) != 0) {
+            throw bad_alloc();
+        }
+        return static_cast<T *>(p);
+    }
+    void deallocate(T *p, size_t) { free(p); }
+
+    template <class U>
+    struct rebind { typedef AlignedAllocator<U> other; };
+};
+template <class T, class U>
+bool operator==(const AlignedAllocator<T> &, const AlignedAllocator<U> &)
+{
+    return true;
+}
+template <class T, class U>
+bool operator!=(const AlignedAllocator<T> &, const AlignedAllocator<U> &)
+{
+    return false;
+}
+
+typedef vector<double, AlignedAllocator<double>> AlignedVector;
+#endif
@@ -0,0 +1,234 @@
+/*
+ * Generator.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Generator class.
+ */
+#include "Generator.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+/*
+ * constructor
+ * Parameters:  fewest and most values a variable may have, and the seed
+ */
+Generator::Generator(int minA, int maxA, uint64_t seed) : rng(seed)
+{
+    minArity = minA;
+    maxArity = maxA;
+}
+/*
+ * chain()
+ * Purpose:     adds a chain of variables, each the parent of the next
+ * Parameters:  number of variables
+ * Returns:     none
+ */
+void Generator::chain(int n)
+{
+    int first = names.size();
+    addVars(n);
+    for (int i = first + 1; i < first + n; i++) {
+        parents[i].push_back(i - 1);
+    }
+}
+/*
+ * polytree()
+ * Purpose:     adds a polytree: a connected network with no undirected
+ *              cycle, so every variable's parents lie in different parts
+ *              of the network before they meet at it
+ * Parameters:  number of variables and the most parents of one variable
+ * Returns:     none
+ */
+void Generator::polytree(int n, int inDegree)
+{
+    int first = names.size();
+    addVars(n);
+    vector<int> part(n); // union-find over the variables added so far
+    for (int i = 0; i < n; i++) {
+        part[i] = i;
+    }
+    auto root = [&part](int i) {
+        while (part[i] != i) {i = part[i] = part[part[i]];}
+        return i;
+    };
+    for (int i = 1; i < n; i++) {
+        int want = below(inDegree + 1); // none starts a new part
+        for (int tries = 0; tries < 4 * want and
+             (int)parents[first + i].size() < want; tries++) {
+            int p = below(i);
+            if (root(p) == root(i)) {continue;} // would close a cycle
+            parents[first + i].push_back(first + p);
+            part[root(p)] = root(i);
+        }
+    }
+    // join the parts: the lowest variable of a part has no parents, so
+    // give it one from the parts before it
+    for (int i = 1; i < n; i++) {
+        if (root(i) != root(0) and parents[first + i].empty()) {
+            int p = below(i);
+            while (root(p) == root(i)) {p = below(i);}
+            parents[first + i].push_back(first + p);
+            part[root(p)] = root(i);
+        }
+    }
+}
+/*
+ * grid()
+ * Purpose:     adds a grid of variables, each a child of its neighbours
+ *              above and to the left
+ * Parameters:  rows and columns
+ * Returns:     none
+ */
+void Generator::grid(int rows, int cols)
+{
+    int first = names.size();
+    addVars(rows * cols);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int v = first + r * cols + c;
+            if (r > 0) {parents[v].push_back(v - cols);}
+            if (c > 0) {parents[v].push_back(v - 1);}
+        }
+    }
+}
+/*
+ * dag()
+ * Purpose:     adds a random DAG in which every variable has inDegree
+ *              parents, or all the earlier variables it may choose from
+ *              when there are fewer
+ * Parameters:  number of variables, parents of each, and how many of the
+ *              variables just before one it picks its parents from (0 for
+ *              all of them), which bounds the network's width
+ * Returns:     none
+ */
+void Generator::dag(int n, int inDegree, int window)
+{
+    int first = names.size();
+    addVars(n);
+    vector<int> pool;
+    for (int i = 1; i < n; i++) {
+        int from = window > 0 ? max(0, i - window) : 0;
+        pool.clear();
+        for (int p = from; p < i; p++) {
+            pool.push_back(p);
+        }
+        for (int k = 0; k < inDegree and !pool.empty(); k++) {
+            int pick = below(pool.size());
+            parents[first + i].push_back(first + pool[pick]);
+            pool[pick] = pool.back();
+            pool.pop_back();
+        }
+    }
+}
+
+int Generator::numVars() const
+{
+    return names.size();
+}
+
+int Generator::numEdges() const
+{
+    int edges = 0;
+    for (size_t v = 0; v < parents.size(); v++) {
+        edges += parents[v].size();
+    }
+    return edges;
+}
+/*
+ * write()
+ * Purpose:     writes the network with a fresh random CPT for every
+ *              variable
+ * Parameters:  stream
+ * Returns:     none
+ */
+void Generator::write(ostream &out)
+{
+    for (size_t v = 0; v < names.size(); v++) {
+        out << names[v];
+        for (int x = 0; x < card[v]; x++) {
+            out << " v" << x;
+        }
+        out << "\n";
+    }
+    out << "# Parents\n";
+    for (size_t v = 0; v < names.size(); v++) {
+        if (parents[v].empty()) {continue;}
+        out << names[v];
+        for (size_t i = 0; i < parents[v].size(); i++) {
+            out << " " << names[parents[v][i]];
+        }
+        out << "\n";
+    }
+    out << "# Tables\n";
+    for (size_t v = 0; v < names.size(); v++) {
+        writeCPT(out, v);
+    }
+}
+/*
+ * addVars()
+ * Purpose:     adds variables with no parents yet. Their names end in a
+ *              letter, since a lone word ending in a digit reads as a CPT
+ *              row.
+ * Parameters:  number of variables
+ * Returns:     none
+ */
+void Generator::addVars(int n)
+{
+    for (int i = 0; i < n; i++) {
+        names.push_back("V" + to_string(names.size()) + "x");
+        card.push_back(minArity + below(maxArity - minArity + 1));
+        parents.push_back(vector<int>());
+    }
+}
+/*
+ * below()
+ * Purpose:     random integer in [0, n)
+ */
+int Generator::below(int n)
+{
+    return rng.next() % n;
+}
+/*
+ * writeCPT()
+ * Purpose:     writes a variable's CPT, one row per combination of parent
+ *              values with the last parent varying fastest. Each row is
+ *              drawn from a Dirichlet with every weight at least 1/20th of
+ *              the mean, so no query has impossible evidence. The last
+ *              probability of a row is left implied.
+ * Parameters:  stream and variable
+ * Returns:     none
+ */
+void Generator::writeCPT(ostream &out, int var)
+{
+    out << names[var] << "\n";
+    const vector<int> &ps = parents[var];
+    vector<int> value(ps.size(), 0);
+    vector<double> weight(card[var]);
+    char buf[32];
+    bool more = true;
+    while (more) {
+        for (size_t i = 0; i < ps.size(); i++) {
+            out << "v" << value[i] << " ";
+        }
+        double total = 0;
+        for (int x = 0; x < card[var]; x++) {
+            weight[x] = 0.05 - log(1 - rng.uniform());
+            total += weight[x];
+        }
+        for (int x = 0; x < card[var] - 1; x++) {
+            snprintf(buf, sizeof(buf), "%.6f", weight[x] / total);
+            out << (x > 0 ? " " : "") << buf;
+        }
+        out << "\n";
+        more = false; // step to the next combination of parent values
+        for (int i = ps.size() - 1; i >= 0 and !more; i--) {
+            if (++value[i] < card[ps[i]]) {
+                more = true;
+            } else {
+                value[i] = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * Generator.h
+ * by: Valerie Zhang
+ *
+ * Purpose: The Generator class makes synthetic networks for testing and
+ *          benchmarking: chains, polytrees, grids and random DAGs with a
+ *          set in-degree, each variable with a random number of values in
+ *          a given range and random CPTs. The same seed always gives the
+ *          same network. Networks are written in the text format the
+ *          Parser reads.
+ */
+#ifndef _GENERATOR_H_
+#define _GENERATOR_H_
+
+#include "Random.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Generator {
+public:
+    Generator(int minArity, int maxArity, uint64_t seed);
+
+    void chain(int n);
+    void polytree(int n, int inDegree);
+    void grid(int rows, int cols);
+    void dag(int n, int inDegree, int window);
+
+    int numVars() const;
+    int numEdges() const;
+    void write(ostream &out);
+
+private:
+    int minArity, maxArity; // values per variable
+    Random rng;
+    vector<string> names;
+    vector<int> card;
+    vector<vector<int>> parents; // of each variable, all earlier ones
+
+    void addVars(int n);
+    int below(int n);
+    void writeCPT(ostream &out, int var);
+};
+#endif
@@ -0,0 +1,304 @@
+/*
+ * Gibbs.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Gibbs class.
+ */
+#include "Gibbs.h"
+#include <cmath>
+#include <sstream>
+
+using namespace std;
+
+static const int BLOCK = 50;        // sweeps per block of counts
+static const int ROUND_BLOCKS = 10; // blocks each chain runs between checks
+static const double RHAT_MAX = 1.01;
+static const double MIN_ESS = 400;
+static const int MIN_HALF = 10;     // kept blocks per half chain to trust R-hat
+// R-hat of chains that each stay put apart from the others; -Ofast assumes
+// there are no infinities, so it is a finite number above any real one
+static const double RHAT_APART = 1e300;
+
+/*
+ * constructor
+ */
+Gibbs::Gibbs(const Model &m, int chains, long samples, double target,
+             uint64_t s, WorkStealingPool *p) : Engine(m)
+{
+    pool = p;
+    numChains = max(chains, 2); // R-hat compares chains
+    maxSamples = samples;
+    targetError = target;
+    seed = s;
+}
+/*
+ * ask()
+ * Purpose:     estimates the distribution of the query variable
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none; dist is already normalized
+ */
+void Gibbs::ask(QueryContext &ctx, int query, const vector<int> &evidence,
+                vector<double> &dist) const
+{
+    vector<int> pruned = evidence;
+    if (!relevant(query, pruned, ctx.needed)) {
+        dist.assign(model.getNumVal(query), 0);
+        return;
+    }
+    vector<vector<double>> dists;
+    run(ctx, pruned, vector<int>(1, query), dists);
+    dist = dists[query];
+}
+/*
+ * askAll()
+ * Purpose:     estimates every posterior from the same chains
+ * Parameters:  context, evidence and the vectors to fill, one per
+ *              variable
+ * Returns:     none
+ */
+void Gibbs::askAll(QueryContext &ctx, const vector<int> &evidence,
+                   vector<vector<double>> &dists) const
+{
+    vector<int> targets;
+    for (int v = 0; v < model.numVars(); v++) {
+        if (evidence[v] == NONE) {targets.push_back(v);}
+    }
+    if (!possibleEvidence(model, evidence)) { // every posterior is all 0
+        dists.assign(model.numVars(), vector<double>());
+        for (size_t i = 0; i < targets.size(); i++) {
+            dists[targets[i]].assign(model.getNumVal(targets[i]), 0);
+        }
+        return;
+    }
+    ctx.needed.assign(model.numVars(), true);
+    run(ctx, evidence, targets, dists);
+}
+/*
+ * run()
+ * Purpose:     runs the chains a round at a time until they have mixed or
+ *              the sample budget is spent
+ * Parameters:  context, evidence, variables to estimate and vectors to
+ *              fill
+ * Returns:     none
+ */
+void Gibbs::run(QueryContext &ctx, const vector<int> &evidence,
+                const vector<int> &targets,
+                vector<vector<double>> &dists) const
+{
+    vector<int> hidden; // resampled each sweep, parents first
+    for (int i = 0; i < model.numVars(); i++) {
+        int v = model.getOrder()[i];
+        if (ctx.needed[v] and evidence[v] == NONE) {hidden.push_back(v);}
+    }
+    vector<int> offset(1, 0); // first count of each target in a block
+    for (size_t i = 0; i < targets.size(); i++) {
+        offset.push_back(offset.back() + model.getNumVal(targets[i]));
+    }
+    vector<Chain *> chains;
+    for (int k = 0; k < numChains; k++) {
+        chains.push_back(new Chain(seed, k, &ctx.needed));
+        start(*chains[k], evidence, hidden);
+    }
+    long budget = max(maxSamples / numChains / BLOCK, (long)ROUND_BLOCKS);
+    int blocks = 0;
+    double rhat = 0, ess = 0;
+    bool mixed = false;
+    while (!mixed and blocks < budget) {
+        int round = min((long)ROUND_BLOCKS, budget - blocks);
+        WorkStealingPool::Group group;
+        for (int k = 0; k < numChains; k++) {
+            Chain *c = chains[k];
+            if (pool == NULL) {
+                runBlocks(*c, hidden, targets, offset, round);
+                continue;
+            }
+            pool->spawn(group, [this, c, &hidden, &targets, &offset, round]() {
+                runBlocks(*c, hidden, targets, offset, round);
+            });
+        }
+        if (pool != NULL) {pool->wait(group);}
+        blocks += round;
+        mixed = diagnose(chains, targets, offset, blocks, dists, ctx.errors,
+                         rhat, ess);
+    }
+    if (!mixed) { // Inference prints it, to whoever asked
+        ostringstream warning;
+        warning << "Gibbs chains did not mix within " << maxSamples
+                << " samples (R-hat ";
+        if (rhat >= RHAT_APART) {
+            warning << "unbounded";
+        } else {
+            warning << rhat;
+        }
+        warning << ", ESS " << ess << ")";
+        ctx.warning = warning.str();
+    }
+    for (int k = 0; k < numChains; k++) {
+        delete chains[k];
+    }
+}
+/*
+ * start()
+ * Purpose:     sets a chain's first state by forward sampling the hidden
+ *              variables with the evidence clamped
+ * Parameters:  chain, evidence and hidden variables in topological order
+ * Returns:     none
+ */
+void Gibbs::start(Chain &c, const vector<int> &evidence,
+                  const vector<int> &hidden) const
+{
+    c.state = evidence;
+    for (size_t i = 0; i < hidden.size(); i++) {
+        int v = hidden[i];
+        const double *row = model.getCPT(v) +
+                            model.getRow(v, c.state.data()) *
+                            model.getNumVal(v);
+        double u = c.rng.uniform();
+        int x = 0;
+        for (double below = row[0]; x < model.getNumVal(v) - 1 and u >= below;
+             below += row[++x]) {}
+        c.state[v] = x;
+    }
+}
+/*
+ * runBlocks()
+ * Purpose:     runs blocks of sweeps over the hidden variables, counting
+ *              how often each target takes each value
+ * Parameters:  chain, hidden variables, targets, first count of each
+ *              target in a block and number of blocks
+ * Returns:     none
+ */
+void Gibbs::runBlocks(Chain &c, const vector<int> &hidden,
+                      const vector<int> &targets, const vector<int> &offset,
+                      int blocks) const
+{
+    for (int b = 0; b < blocks; b++) {
+        size_t first = c.counts.size();
+        c.counts.resize(first + offset.back(), 0);
+        uint16_t *count = &c.counts[first];
+        for (int s = 0; s < BLOCK; s++) {
+            for (size_t i = 0; i < hidden.size(); i++) {
+                resample(c, hidden[i]);
+            }
+            for (size_t t = 0; t < targets.size(); t++) {
+                count[offset[t] + c.state[targets[t]]]++;
+            }
+        }
+    }
+}
+/*
+ * resample()
+ * Purpose:     draws a new value of a variable given its Markov blanket:
+ *              its parents, its children and their other parents
+ * Parameters:  chain and variable
+ * Returns:     none
+ */
+void Gibbs::resample(Chain &c, int var) const
+{
+    int card = model.getNumVal(var);
+    int *state = c.state.data();
+    int old = state[var];
+    c.weight.resize(card);
+    double total = 0;
+    for (int x = 0; x < card; x++) {
+        state[var] = x;
+        double p = model.getProbability(var, state);
+        for (int i = 0; i < model.getNumChildren(var); i++) {
+            int child = model.getChildren(var)[i];
+            if ((*c.needed)[child]) { // barren children sum out to 1
+                p *= model.getProbability(child, state);
+            }
+        }
+        c.weight[x] = p;
+        total += p;
+    }
+    if (total <= 0) { // no value fits the evidence; stay put
+        state[var] = old;
+        return;
+    }
+    double u = c.rng.uniform() * total;
+    int x = 0;
+    for (double below = c.weight[0]; x < card - 1 and u >= below;
+         below += c.weight[++x]) {}
+    state[var] = x;
+}
+/*
+ * diagnose()
+ * Purpose:     pools the chains' estimates and checks whether they mixed.
+ *              The first half of every chain is dropped as burn-in and the
+ *              rest is split in two, so each chain is also compared with
+ *              itself (split R-hat). Block means stand in for single
+ *              sweeps, which gives the effective sample size by batch
+ *              means.
+ * Parameters:  chains, targets, first count of each target in a block,
+ *              blocks each chain has run, vectors to fill with the
+ *              estimates and their standard errors, and the worst R-hat
+ *              and least effective sample size seen
+ * Returns:     true if every estimate has mixed
+ */
+bool Gibbs::diagnose(const vector<Chain *> &chains, const vector<int> &targets,
+                     const vector<int> &offset, int blocks,
+                     vector<vector<double>> &dists,
+                     vector<vector<double>> &errors, double &worstRhat,
+                     double &leastESS) const
+{
+    int half = (blocks - blocks / 2) / 2; // blocks in each kept half chain
+    int first = blocks - 2 * half;        // first kept block
+    int m = 2 * chains.size();            // half chains
+    double n = half;
+    double sweeps = m * n * BLOCK;
+    worstRhat = 1;
+    leastESS = sweeps;
+    bool mixed = half >= MIN_HALF;
+    dists.assign(model.numVars(), vector<double>());
+    errors.assign(model.numVars(), vector<double>());
+    vector<double> mean(m), var(m);
+    for (size_t t = 0; t < targets.size(); t++) {
+        int card = model.getNumVal(targets[t]);
+        dists[targets[t]].assign(card, 0);
+        errors[targets[t]].assign(card, 0);
+        for (int x = 0; x < card; x++) {
+            int k = offset[t] + x;
+            double all = 0;
+            for (int h = 0; h < m; h++) { // mean and variance of block means
+                const Chain *c = chains[h / 2];
+                int from = first + (h % 2) * half;
+                double sum = 0, sumSq = 0;
+                for (int b = from; b < from + half; b++) {
+                    double y = c->counts[b * offset.back() + k] /
+                               (double)BLOCK;
+                    sum += y;
+                    sumSq += y * y;
+                }
+                mean[h] = sum / n;
+                var[h] = n > 1 ? max(sumSq - sum * mean[h], 0.0) / (n - 1) : 0;
+                all += mean[h];
+            }
+            all /= m;
+            double w = 0, between = 0;
+            for (int h = 0; h < m; h++) {
+                w += var[h] / m;
+                between += n * (mean[h] - all) * (mean[h] - all) / (m - 1);
+            }
+            double varPlus = (n - 1) / n * w + between / n;
+            double rhat = 1;
+            if (w > 0) {
+                rhat = sqrt(varPlus / w);
+            } else if (between > 0) {
+                rhat = RHAT_APART;
+            }
+            // a sweep's variance over the variance of its mean
+            double ess = sweeps;
+            if (varPlus > 0) {
+                ess = min(sweeps, all * (1 - all) / (BLOCK * varPlus) * sweeps);
+            }
+            dists[targets[t]][x] = all;
+            errors[targets[t]][x] = sqrt(BLOCK * varPlus / sweeps);
+            worstRhat = max(worstRhat, rhat);
+            leastESS = min(leastESS, ess);
+            mixed = mixed and rhat <= RHAT_MAX and ess >= MIN_ESS and
+                    (targetError <= 0 or errors[targets[t]][x] <= targetError);
+        }
+    }
+    return mixed;
+}
@@ -0,0 +1,65 @@
+/*
+ * Gibbs.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Approximate inference by Gibbs sampling, for evidence too
+ *          unlikely for likelihood weighting. Several independent chains
+ *          each resample every hidden variable from its Markov blanket.
+ *          The chains run as parallel tasks on a WorkStealingPool, and
+ *          stop as soon as the split R-hat and effective sample size of
+ *          the pooled estimates say they have mixed, or the sample budget
+ *          runs out.
+ */
+#ifndef _GIBBS_H_
+#define _GIBBS_H_
+
+#include "Engine.h"
+#include "Random.h"
+#include "WorkStealingPool.h"
+#include <stdint.h>
+
+using namespace std;
+
+class Gibbs : public Engine {
+public:
+    Gibbs(const Model &m, int chains, long samples, double targetError,
+          uint64_t seed, WorkStealingPool *p = NULL);
+
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+    void askAll(QueryContext &ctx, const vector<int> &evidence,
+                vector<vector<double>> &dists) const;
+    bool exact() const { return false; }
+
+private:
+    struct Chain {
+        Random rng;
+        vector<int> state;      // current value of every variable
+        vector<uint16_t> counts; // per block, sweeps with each target value
+        vector<double> weight;  // scratch for the blanket distribution
+        const vector<bool> *needed; // the query's, shared by the chains
+        Chain(uint64_t seed, uint64_t stream, const vector<bool> *n)
+            : rng(seed, stream), needed(n) {}
+    };
+
+    WorkStealingPool *pool; // NULL to run the chains one after another
+    int numChains;
+    long maxSamples;        // sweeps of all the chains together
+    double targetError;     // also wait for the standard errors, or 0
+    uint64_t seed;
+
+    void run(QueryContext &ctx, const vector<int> &evidence,
+             const vector<int> &targets, vector<vector<double>> &dists) const;
+    void start(Chain &c, const vector<int> &evidence,
+               const vector<int> &hidden) const;
+    void runBlocks(Chain &c, const vector<int> &hidden,
+                   const vector<int> &targets, const vector<int> &offset,
+                   int blocks) const;
+    void resample(Chain &c, int var) const;
+    bool diagnose(const vector<Chain *> &chains, const vector<int> &targets,
+                  const vector<int> &offset, int blocks,
+                  vector<vector<double>> &dists,
+                  vector<vector<double>> &errors, double &worstRhat,
+                  double &leastESS) const;
+};
+#endif
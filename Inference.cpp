@@ -6,36 +6,545 @@
  *
  */
 #include "Inference.h"
+#include "Enumeration.h"
+#include "BinaryEnumeration.h"
+#include "VariableElimination.h"
+#include "JunctionTree.h"
+#include "RecursiveConditioning.h"
+#include "ArithmeticCircuit.h"
+#include "LikelihoodWeighting.h"
+#include "Gibbs.h"
+#include "MaxProduct.h"
+#include "ThreadPool.h"
+#include "Server.h"
+#include "Parser.h"
+#include <algorithm>
+#include <unistd.h>
 
 using namespace std;
 
-Inference::Inference() {}
+Inference::Inference()
+    : engine(NULL), context(NULL), splitPool(NULL), cache(0) {}
 
-Inference::Inference(string filename) 
+Inference::Inference(string filename, Options opts)
+    : engine(NULL), context(NULL), splitPool(NULL), cache(opts.cacheSize)
 {
-    cout << "\nLoading file \"" << filename << "\"\n\n";
-    BayesNet.openAndParse(filename, vars);
+    options = opts;
+    if (options.batchFile.empty() and options.scoreFile.empty() and
+        options.serveAddress.empty() and options.threads > 1) {
+        // one query at a time, so spread each query over the cores
+        splitPool = new WorkStealingPool(options.threads);
+    }
+    load(filename);
+    if (engine == NULL) {
+        cerr << "Error: unknown engine " << options.engine << "\n";
+        exit(EXIT_FAILURE);
+    }
+}
+/*
+ * load()
+ * Purpose:     parses a network file into a new model, or maps a compiled
+ *              model file, replacing the current model, and drops every
+ *              cached result
+ * Parameters:  filename
+ * Returns:     none
+ */
+void Inference::load(string filename)
+{
+    // batch and score results go to cout, so keep it clean of anything else
+    ostream &log = options.batchFile.empty() and options.scoreFile.empty() and
+                   options.compileFile.empty() ? cout : cerr;
+    if (!options.quiet) {
+        log << "\nLoading file \"" << filename << "\"\n\n";
+    }
+    if (Model::isCompiled(filename)) {
+        model.load(filename); // used in place, nothing to parse
+    } else {
+        Parser parser;
+        parser.parse(filename, model); // straight into the model
+    }
+    cache.clear();
+    observed.assign(model.numVars(), NONE); // names may mean other things
+    setEngine(options.engine); // engines may hold structures of the old model
+}
+
+/*
+ * save()
+ * Purpose:     writes the current model as a compiled model file
+ * Parameters:  filename
+ * Returns:     none
+ */
+void Inference::save(string filename) const
+{
+    model.save(filename);
 }
 
 Inference::~Inference() 
 {
-    distribution.clear();
-    evidence.clear();
+    delete context;
+    delete engine;
+    delete splitPool;
+}
+/*
+ * setEngine()
+ * Purpose:     selects the inference algorithm
+ * Parameters:  engine name ("enum", "ve", "jt", "rc", "ac", "lw" or "gibbs")
+ * Returns:     true if the name is known, false if not
+ */
+bool Inference::setEngine(string name)
+{
+    Engine *next = makeEngine(name);
+    if (next == NULL) {return false;}
+    delete context;
+    delete engine;
+    engine = next;
+    context = engine->newContext();
+    options.engine = name;
+    return true;
+}
+/*
+ * makeEngine()
+ * Purpose:     creates an engine on the current model
+ * Parameters:  engine name
+ * Returns:     new engine, or NULL if the name is unknown
+ */
+Engine *Inference::makeEngine(string name) const
+{
+    Engine *e = NULL;
+    if (name == "enum" and BinaryEnumeration::applies(model)) {
+        e = new BinaryEnumeration(model, splitPool);
+    } else if (name == "enum") {
+        e = new Enumeration(model, splitPool);
+    } else if (name == "ve") {
+        e = new VariableElimination(model, options.heuristic);
+    } else if (name == "jt") {
+        e = new JunctionTree(model, options.heuristic);
+    } else if (name == "rc") {
+        e = new RecursiveConditioning(model, options.heuristic,
+                                      options.cacheMB << 20);
+    } else if (name == "ac") {
+        e = new ArithmeticCircuit(model, options.heuristic,
+                                  options.circuitFile);
+    } else if (name == "lw") {
+        e = new LikelihoodWeighting(model, options.samples,
+                                    options.targetError, options.seed,
+                                    splitPool);
+    } else if (name == "gibbs") {
+        e = new Gibbs(model, options.chains, options.samples,
+                      options.targetError, options.seed, splitPool);
+    }
+    if (e != NULL) {
+        e->setPrune(options.prune);
+        e->setLogSpace(options.logSpace);
+    }
+    return e;
 }
 
+/*
+ * newContext()
+ * Purpose:     makes a context for a thread to ask the current engine with;
+ *              it is only good until the engine or the model changes
+ * Parameters:  none
+ * Returns:     new context, owned by the caller
+ */
+QueryContext *Inference::newContext() const
+{
+    return engine->newContext();
+}
+/*
+ * ask()
+ * Purpose:     answers a query with the current engine, as a query typed
+ *              at the prompt would be. Threads may ask at once, each with
+ *              a context of its own.
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none; dist is normalized, or empty if the evidence is
+ *              impossible
+ */
+void Inference::ask(QueryContext &ctx, int var, const vector<int> &evidence,
+                    vector<double> &dist)
+{
+    eAsk(ctx, var, evidence, dist);
+}
+/*
+ * ask()
+ * Purpose:     answers a query with the prompt's context
+ * Parameters:  query variable, evidence and distribution to fill
+ * Returns:     none; dist is normalized, or empty if the evidence is
+ *              impossible
+ */
+void Inference::ask(int var, const vector<int> &evidence, vector<double> &dist)
+{
+    eAsk(*context, var, evidence, dist);
+}
 void Inference::run() 
 {
     string input = "";
     while (getline(cin, input)) {
         if (input == "quit") {break;}
-        string query = getQueryAndEvidence(input); // get query variable
-        eAsk(query); // run algorithm
-        printDistribution(); // print distribution
-        reset();
+        if (command(input)) {continue;}
+        Stats::reset(); // the stats command reports the last query
+        answer(*context, input, cout, cerr);
+        if (options.stats) {Stats::report(cout);}
+    }
+}
+/*
+ * runBatch()
+ * Purpose:     answers every query in a file on a pool of threads sharing
+ *              the model, writing the results to cout in input order
+ * Parameters:  query file and number of threads
+ * Returns:     none; exits with an error if cout could not take them
+ */
+void Inference::runBatch(string filename, int threads)
+{
+    ifstream infile(filename);
+    if (!infile.is_open()) {
+        cerr << "Error: could not open " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    ThreadPool pool(threads);
+    Stats::reset();
+    vector<QueryContext *> contexts(pool.size()); // one engine, shared
+    for (int w = 0; w < pool.size(); w++) {
+        contexts[w] = engine->newContext();
+    }
+    // queries are read, answered and written a block at a time so memory
+    // stays bounded however long the file is
+    const size_t BLOCK = 4096;
+    const size_t PER_TASK = 16;
+    vector<string> lines;
+    vector<stringstream> results(BLOCK);
+    string line;
+    bool more = true;
+    while (more) {
+        lines.clear();
+        while (lines.size() < BLOCK and (more = static_cast<bool>(getline(infile, line)))) {
+            if (!line.empty()) {lines.push_back(line);}
+        }
+        for (size_t start = 0; start < lines.size(); start += PER_TASK) {
+            size_t end = min(start + PER_TASK, lines.size());
+            pool.submit([this, &contexts, &lines, &results, start, end](int w) {
+                for (size_t i = start; i < end; i++) {
+                    results[i].str("");
+                    answer(*contexts[w], lines[i], results[i], cerr);
+                }
+            });
+        }
+        pool.wait();
+        for (size_t i = 0; i < lines.size(); i++) {
+            cout << results[i].str();
+        }
+    }
+    for (int w = 0; w < pool.size(); w++) {
+        delete contexts[w];
+    }
+    if (options.stats) { // totals of the batch; cout holds the results
+        cerr << "Batch statistics, summed over the threads:\n";
+        Stats::report(cerr);
+    }
+    if (!(cout << flush)) {
+        cerr << "Error: could not write the results\n";
+        exit(EXIT_FAILURE);
     }
 }
+/*
+ * score()
+ * Purpose:     answers one query under every evidence row of a file. The
+ *              first line names the query and the variables the rows set,
+ *                  Burglary | JohnCalls, MaryCalls
+ *              and every other line gives their values in that order (*
+ *              leaves one unobserved). Rows are asked of the engine a
+ *              block at a time, on a pool of threads, so engines that can
+ *              (ac) evaluate many rows in one pass. Writes the query's
+ *              value names, then one line of probabilities per row, to
+ *              cout in input order.
+ * Parameters:  evidence file and number of threads
+ * Returns:     none; exits with an error if cout could not take them
+ */
+void Inference::score(string filename, int threads)
+{
+    ifstream infile(filename);
+    if (!infile.is_open()) {
+        cerr << "Error: could not open " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    int query = NONE;
+    vector<int> vars;
+    string line;
+    size_t lineNum = 1;
+    if (!getline(infile, line) or !readScoreHeader(line, query, vars)) {
+        cerr << "Error: " << filename << ":1: expected Query | Var, ...\n";
+        exit(EXIT_FAILURE);
+    }
+    int card = model.getNumVal(query);
+    for (int x = 0; x < card; x++) {
+        cout << (x == 0 ? "" : " ") << model.getValueName(query, x);
+    }
+    cout << "\n";
+    ThreadPool pool(threads);
+    Stats::reset();
+    vector<QueryContext *> contexts(pool.size()); // one engine, shared
+    for (int w = 0; w < pool.size(); w++) {
+        contexts[w] = engine->newContext();
+    }
+    // rows are read, answered and written a block at a time so memory
+    // stays bounded however long the file is
+    const size_t BLOCK = 4096;
+    const size_t PER_TASK = 256;
+    size_t k = vars.size();
+    vector<int> values;
+    vector<int> row(k);
+    vector<stringstream> results((BLOCK + PER_TASK - 1) / PER_TASK);
+    bool more = true;
+    while (more) {
+        values.clear();
+        size_t rows = 0;
+        while (rows < BLOCK and
+               (more = static_cast<bool>(getline(infile, line)))) {
+            lineNum++;
+            if (line.find_first_not_of(" \t\r") == string::npos) {continue;}
+            if (!readScoreRow(line, vars, row)) {
+                cerr << "Error: " << filename << ":" << lineNum
+                     << ": expected " << k << " values of the variables\n";
+                exit(EXIT_FAILURE);
+            }
+            values.insert(values.end(), row.begin(), row.end());
+            rows++;
+        }
+        for (size_t start = 0; start < rows; start += PER_TASK) {
+            size_t end = min(start + PER_TASK, rows);
+            pool.submit([this, &contexts, &vars, &values, &results, query,
+                         card, k, start, end](int w) {
+                vector<int> part(values.begin() + start * k,
+                                 values.begin() + end * k);
+                vector<double> dists;
+                {
+                    STAT_TIMER(INFERENCE);
+                    engine->askBatch(*contexts[w], query, observed, vars,
+                                     part, end - start, dists);
+                }
+                stringstream &out = results[start / PER_TASK];
+                out.str("");
+                vector<double> dist;
+                for (size_t r = 0; r < end - start; r++) {
+                    dist.assign(dists.begin() + r * card,
+                                dists.begin() + (r + 1) * card);
+                    if (!normalize(dist)) {out << "impossible";}
+                    for (size_t x = 0; x < dist.size(); x++) {
+                        out << (x == 0 ? "" : " ") << setprecision(6)
+                            << dist[x];
+                    }
+                    out << "\n";
+                }
+            });
+        }
+        pool.wait();
+        for (size_t start = 0; start < rows; start += PER_TASK) {
+            cout << results[start / PER_TASK].str();
+        }
+    }
+    for (int w = 0; w < pool.size(); w++) {
+        delete contexts[w];
+    }
+    if (options.stats) { // totals of the rows; cout holds the results
+        cerr << "Score statistics, summed over the threads:\n";
+        Stats::report(cerr);
+    }
+    if (!(cout << flush)) {
+        cerr << "Error: could not write the results\n";
+        exit(EXIT_FAILURE);
+    }
+}
+/*
+ * serve()
+ * Purpose:     answers queries from clients of a socket until SIGINT or
+ *              SIGTERM, each on a pool of threads sharing the model and
+ *              the result cache. A reply is what the prompt would print,
+ *              errors included, ending with its only blank line.
+ * Parameters:  Unix socket path, or TCP port on 127.0.0.1, and number of
+ *              threads
+ * Returns:     none
+ */
+void Inference::serve(string address, int threads)
+{
+    ThreadPool pool(threads);
+    vector<QueryContext *> contexts(pool.size()); // one engine, shared
+    for (int w = 0; w < pool.size(); w++) {
+        contexts[w] = engine->newContext();
+    }
+    Server server(address, pool,
+                  [this, &contexts](int w, const string &line, ostream &out) {
+                      answer(*contexts[w], line, out, out);
+                  });
+    cout << "Listening on " << server.describe() << endl;
+    server.run();
+    cout << "Stopped" << endl;
+    for (int w = 0; w < pool.size(); w++) {
+        delete contexts[w];
+    }
+}
+/*
+ * command()
+ * Purpose:     handles REPL commands that are not queries:
+ *                  engine <name>   switches the inference algorithm
+ *                  load <file>     reloads the model
+ *                  cache           prints result cache counters
+ *                  stats           prints the last query's statistics
+ *                  memory          prints the memory the model takes
+ *                  observe ...     adds or changes session evidence
+ *                  retract ...     removes session evidence
+ *                  evidence        prints the session evidence
+ * Parameters:  input line
+ * Returns:     true if the line was a command, false if it is a query
+ */
+bool Inference::command(string input)
+{
+    stringstream ss(input);
+    string word, arg, extra;
+    ss >> word;
+    if (word == "observe" or word == "retract") {
+        return observe(input.substr(input.find(word) + word.size()),
+                       word == "retract");
+    }
+    bool hasArg = static_cast<bool>(ss >> arg);
+    if (ss >> extra) {return false;}
+    if (word == "engine" and hasArg) {
+        if (setEngine(arg)) {
+            cout << "Using engine " << arg << "\n\n";
+        } else {
+            cerr << "Error: unknown engine " << arg << "\n";
+        }
+    } else if (word == "load" and hasArg) {
+        load(arg);
+    } else if (word == "cache" and !hasArg) {
+        cout << "Cache: " << cache.getHits() << " hits, "
+             << cache.getMisses() << " misses, " << cache.size() << "/"
+             << options.cacheSize << " entries\n\n";
+    } else if (word == "memory" and !hasArg) {
+        printMemory(cout);
+    } else if (word == "evidence" and !hasArg) {
+        printObserved(cout);
+    } else if (word == "stats" and !hasArg) {
+        if (Stats::enabled()) {
+            Stats::report(cout);
+        } else {
+            cerr << "Error: statistics are not compiled into this build; "
+                 << "rebuild with make STATS=1\n";
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+/*
+ * observe()
+ * Purpose:     changes the session evidence, which every later query is
+ *              asked under, as the arguments of
+ *                  observe Var = value[, Var = value ...]
+ *                  retract Var[, Var ...]    (or retract * for all)
+ *              Nothing changes if a name is unknown. Engines that keep
+ *              work between queries (jt) only redo the part the change
+ *              touches.
+ * Parameters:  arguments and whether to retract rather than observe
+ * Returns:     true; the line was one of the commands
+ */
+bool Inference::observe(string input, bool retract)
+{
+    replace(input.begin(), input.end(), ',', ' ');
+    if (!retract) {replace(input.begin(), input.end(), '=', ' ');}
+    stringstream ss(input);
+    vector<int> next = observed;
+    string name, value;
+    while (ss >> name) {
+        if (retract and name == "*") {
+            next.assign(model.numVars(), NONE);
+            continue;
+        }
+        int var = model.getVar(name);
+        if (var == NONE) {
+            cerr << "Error: unknown variable " << name << "\n";
+            return true;
+        }
+        if (retract) {
+            next[var] = NONE;
+            continue;
+        }
+        if (!(ss >> value)) {
+            cerr << "Error: no value given for " << name << "\n";
+            return true;
+        }
+        next[var] = model.getValue(var, value);
+        if (next[var] == NONE) {
+            cerr << "Error: unknown value " << value << " of " << name << "\n";
+            return true;
+        }
+    }
+    observed = next;
+    printObserved(cout);
+    return true;
+}
+/*
+ * printObserved()
+ * Purpose:     prints the session evidence
+ * Parameters:  stream
+ * Returns:     none
+ */
+void Inference::printObserved(ostream &out) const
+{
+    out << "Evidence:";
+    bool any = false;
+    for (int v = 0; v < model.numVars(); v++) {
+        if (observed[v] == NONE) {continue;}
+        out << (any ? ", " : " ") << model.getName(v) << " = "
+            << model.getValueName(v, observed[v]);
+        any = true;
+    }
+    out << (any ? "\n\n" : " none\n\n");
+}
+
+/*
+ * answer()
+ * Purpose:     answers one query line under the session evidence and
+ *              prints the result
+ * Parameters:  context to ask with, query line, and streams to print the
+ *              result and errors to
+ * Returns:     none
+ */
+void Inference::answer(QueryContext &ctx, string input, ostream &out,
+                       ostream &err)
+{
+    vector<int> evidence = observed; // the query's own evidence overrides
+    string query;
+    int var = NONE;
+    {
+        STAT_TIMER(PARSE);
+        query = getQueryAndEvidence(input, evidence); // get query variable
+        if (query != "*") {var = model.getVar(query);}
+    }
+    ctx.warning.clear(); // sampling engines explain a poor estimate here
+    if (query == "*") { // every variable under the same evidence
+        askAll(ctx, evidence, out, err);
+        if (!ctx.warning.empty()) {err << "Warning: " << ctx.warning << "\n";}
+        return;
+    }
+    if (query == "mpe" or query == "map") { // most likely values instead
+        explain(input, evidence, out, err);
+        return;
+    }
+    vector<double> dist;
+    if (var == NONE) {
+        err << "Error: unknown variable " << query << "\n";
+    } else {
+        evidence[var] = NONE;
+        eAsk(ctx, var, evidence, dist); // run algorithm
+        if (dist.empty()) {impossible(err);}
+        if (!ctx.warning.empty()) {err << "Warning: " << ctx.warning << "\n";}
+    }
+    STAT_TIMER(PRINT);
+    printDistribution(out, var, dist, ctx.getError(var)); // print distribution
+}
 
-string Inference::getQueryAndEvidence(string input) {
+string Inference::getQueryAndEvidence(string input, vector<int> &evidence) const
+{
     stringstream ss(input);
     string query;
     string word;
@@ -49,156 +558,282 @@ string Inference::getQueryAndEvidence(string input) {
             e.first = word;
             count++;
         } else if (count == 2) { // get evidence variable value
-            if (word.length() == 2) {
-                word.erase(word.begin()+1); // trim commas
+            if (word.back() == ',') {
+                word.erase(word.end()-1); // trim commas
             }
             e.second = word;
-            Node* curr = BayesNet.getEntry(e.first);
-            curr->setVal(word); // sets values in Bayes Net
-            evidence.push_back(e); // add to evidence
+            int var = model.getVar(e.first);
+            if (var != NONE) { // sets value in evidence
+                evidence[var] = model.getValue(var, e.second);
+            }
             count = 0;
         }
     }
     return query;
 }
 /*
- * eAsk()
- * Purpose:     fill distribution table for query variable(before normalization)
- * Parameters:  query variable
- * Returns:     none
+ * readScoreHeader()
+ * Purpose:     reads the first line of a score file, Query | Var, ...
+ * Parameters:  line, and the query and row variables to fill
+ * Returns:     true if every name is known, the row variables are distinct
+ *              and none is the query
  */
-void Inference::eAsk(string query)
+bool Inference::readScoreHeader(string line, int &query,
+                                vector<int> &vars) const
 {
-    Node* curr = BayesNet.getEntry(query);
-    pair<string, double> toAdd;
-    for (int i = 0; i < curr->getNumVal() - 1; i++) { // for each possible value of query
-        toAdd.first = curr->getValue(i);
-        pair<string, string> e = {query, toAdd.first};
-        evidence.push_back(e); // adds X = xi to evidence table
-        curr->setVal(toAdd.first);
-        toAdd.second = eAll(0); // get P(xi, e)
-        distribution.push_back(toAdd); // add to distribution table
-        evidence.pop_back(); // removes values from evidence table
-        curr->setVal("NONE");
+    replace(line.begin(), line.end(), ',', ' ');
+    stringstream ss(line);
+    string name, bar;
+    if (!(ss >> name >> bar) or bar != "|") {return false;}
+    query = model.getVar(name);
+    if (query == NONE) {return false;}
+    vars.clear();
+    vector<bool> seen(model.numVars(), false);
+    seen[query] = true;
+    while (ss >> name) {
+        int var = model.getVar(name);
+        if (var == NONE or seen[var]) {return false;}
+        seen[var] = true;
+        vars.push_back(var);
     }
-    toAdd = {curr->getValue(curr->getNumVal() - 1), 0}; 
-    distribution.push_back(toAdd); // add last entry with value of 0
-    normalize();
+    return true;
 }
 /*
- * eAll()
- * Purpose:     calculates P(xi,e) for distribution using BN
- * Parameters:  none
- * Returns:     P(xi,e)
+ * readScoreRow()
+ * Purpose:     reads one evidence row of a score file: a value of each row
+ *              variable, separated by spaces or commas, * for none
+ * Parameters:  line, row variables, and the values to fill
+ * Returns:     true if there is exactly one known value per variable
  */
-double Inference::eAll(size_t count)
+bool Inference::readScoreRow(string line, const vector<int> &vars,
+                             vector<int> &values) const
 {
-    if (count == vars.size()) { // reached end of vector
-        return 1.0;
+    replace(line.begin(), line.end(), ',', ' ');
+    stringstream ss(line);
+    string word;
+    for (size_t j = 0; j < vars.size(); j++) {
+        if (!(ss >> word)) {return false;}
+        values[j] = word == "*" ? NONE : model.getValue(vars[j], word);
+        if (values[j] == NONE and word != "*") {return false;}
     }
-    string var = vars[count]; // get variable
-    if (inEvidence(var)) { // if in evidence
-        string key = determineKey(var); // get key
-        Node* curr = BayesNet.getEntry(var); 
-        double num = curr->getProbability(key, curr->getIndex(curr->getAssignedVal())); // get probability
-        return num * eAll(count+1); // recurse
+    return !(ss >> word);
+}
+/*
+ * eAsk()
+ * Purpose:     fill distribution for query variable, from the result cache
+ *              when the same query was answered before. Estimates are not
+ *              cached, so asking again draws fresh samples.
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
+ */
+void Inference::eAsk(QueryContext &ctx, int var, const vector<int> &evidence,
+                     vector<double> &dist)
+{
+    if (!engine->exact()) {
+        infer(ctx, var, evidence, dist);
+        return;
+    }
+    string key = ResultCache::makeKey(var, evidence);
+    if (!cache.get(key, dist)) {
+        unsigned long gen = cache.generation();
+        infer(ctx, var, evidence, dist); // run selected algorithm
+        cache.put(key, dist, gen);
     } else {
-        return summation(var, count); // perform summation
+        STAT_COUNT(CACHE_HITS, 1);
     }
 }
 /*
- * summation()
- * Purpose:     calculates summation of probababilities of a variable 
- *              given its parents
- * Parameters:  variable whose probabilities are being summed and var count
- * Returns:     sum
+ * infer()
+ * Purpose:     asks the engine and normalizes its answer, timing each
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
  */
-double Inference::summation(string var, size_t count) 
+void Inference::infer(QueryContext &ctx, int var, const vector<int> &evidence,
+                      vector<double> &dist)
 {
-    Node* curr = BayesNet.getEntry(var);
-    if (curr->getNumChildren() == 0) { //
-        return 1.0;
+    {
+        STAT_TIMER(INFERENCE);
+        engine->ask(ctx, var, evidence, dist);
     }
-    double sum = 0;
-    for (int i = 0; i < curr->getNumVal(); i++) {
-        curr->setVal(curr->getValue(i)); // assign value in BayesNet
-        pair<string, string> e = {var, curr->getAssignedVal()};
-        evidence.push_back(e); // add variable with assigned value to evidence set
-        sum += eAll(count);
-        curr->setVal("NONE"); // reset value in BayesNet
-        evidence.pop_back(); // remove entry from evidence set
-    }
-    return sum;
+    STAT_TIMER(NORMALIZE);
+    normalize(dist); // empty if every value has probability 0
 }
 /*
- * inEvidence()
- * Purpose:     determines if variable is in evidence
- * Parameters:  variable
- * Returns:     true if in evidence, false if not
+ * askAll()
+ * Purpose:     prints the distribution of every variable that is not
+ *              evidence, asking the engine for all of them at once
+ * Parameters:  context, evidence and streams to print the result and
+ *              errors to
+ * Returns:     none
  */
-bool Inference::inEvidence(string var) 
+void Inference::askAll(QueryContext &ctx, const vector<int> &evidence,
+                       ostream &out, ostream &err)
 {
-    for (size_t i = 0; i < evidence.size(); i++) {
-        if (evidence[i].first == var) {
-            return true;
+    vector<vector<double>> dists;
+    unsigned long gen = cache.generation();
+    {
+        STAT_TIMER(INFERENCE);
+        engine->askAll(ctx, evidence, dists);
+    }
+    for (int v = 0; v < model.numVars(); v++) {
+        if (dists[v].empty()) {continue;}
+        bool possible;
+        {
+            STAT_TIMER(NORMALIZE);
+            possible = normalize(dists[v]);
+        }
+        if (!possible) { // so is every other variable's
+            impossible(err);
+            out << "\n\n";
+            return;
         }
+        if (engine->exact()) {
+            cache.put(ResultCache::makeKey(v, evidence), dists[v], gen);
+        }
+        STAT_TIMER(PRINT);
+        out << model.getName(v) << ": ";
+        printDistribution(out, v, dists[v], ctx.getError(v));
     }
-    return false;
 }
 /*
- * determineKey()
- * Purpose:     generates key based on a variable's parents' values for CPT
- * Parameters:  variable 
- * Returns:     key
+ * explain()
+ * Purpose:     answers an MPE query, the most likely values of every
+ *              variable that is not evidence:
+ *                  mpe | Var = value, ...
+ *              or a partial MAP query, the most likely values of a few
+ *              variables with the rest summed out:
+ *                  map Var, Var ... | Var = value, ...
+ *              and prints them with their probability given the evidence
+ * Parameters:  query line, its evidence, and streams to print the result
+ *              and errors to
+ * Returns:     none
  */
-string Inference::determineKey(string var) 
+void Inference::explain(string input, const vector<int> &evidence,
+                        ostream &out, ostream &err) const
 {
-    string key = "";
-    Node* curr = BayesNet.getEntry(var);
-    if (curr->getNumParents() == 0) {
-        key = "NULL";
-        return key;
+    int n = model.numVars();
+    stringstream ss(input.substr(0, input.find('|')));
+    string word, name;
+    ss >> word;
+    bool partial = (word == "map");
+    vector<bool> maximize(n, !partial);
+    while (partial and ss >> name) {
+        if (name[name.size() - 1] == ',') {name.erase(name.size() - 1);}
+        if (name.empty()) {continue;}
+        int var = model.getVar(name);
+        if (var == NONE) {
+            err << "Error: unknown variable " << name << "\n";
+            out << "\n\n"; // the reply still takes its place
+            return;
+        }
+        maximize[var] = true;
+    }
+    if (partial and find(maximize.begin(), maximize.end(), true) ==
+                    maximize.end()) {
+        err << "Error: map needs the variables to maximize\n";
+        out << "\n\n";
+        return;
+    }
+    vector<int> assignment;
+    double p;
+    {
+        STAT_TIMER(INFERENCE);
+        MaxProduct solver(model, options.heuristic, options.prune);
+        p = solver.solve(evidence, maximize, assignment);
     }
-    for (int i = 0; i < curr->getNumParents(); i++) {
-        // get parent's assigned value
-        Node* check = BayesNet.getEntry(curr->getParent(i)); 
-        key += check->getAssignedVal(); // concatenate to key
+    if (p < 0) {
+        err << "Error: the evidence is impossible\n";
+        out << "\n\n";
+        return;
     }
-    return key;
+    STAT_TIMER(PRINT);
+    out << (partial ? "MAP:" : "MPE:");
+    bool any = false;
+    for (int v = 0; v < n; v++) {
+        if (!maximize[v] or evidence[v] != NONE) {continue;}
+        out << (any ? ", " : " ") << model.getName(v) << " = "
+            << model.getValueName(v, assignment[v]);
+        any = true;
+    }
+    out << "\nP(" << (partial ? "MAP" : "MPE") << " | evidence) = "
+        << setprecision(3) << p << "\n\n";
 }
 /*
  * normalize()
  * Purpose:     normalizes probabilities in distribution
- * Parameters:  none
+ * Parameters:  values proportional to P(xi,e)
+ * Returns:     false, leaving dist empty, if they are all 0: the evidence
+ *              is impossible
+ */
+bool Inference::normalize(vector<double> &dist) const
+{
+    double nConstant = 0; // P(e) is the sum of P(xi,e) over all xi
+    for (size_t i = 0; i < dist.size(); i++) {
+        nConstant += dist[i];
+    }
+    if (!(nConstant > 0)) {
+        dist.clear();
+        return false;
+    }
+    for (size_t i = 0; i < dist.size(); i++) { 
+        dist[i] = dist[i]/nConstant; // normalize
+    }
+    return true;
+}
+/*
+ * impossible()
+ * Purpose:     reports a query whose distribution came out all 0
+ * Parameters:  stream to print to
  * Returns:     none
  */
-void Inference::normalize()
+void Inference::impossible(ostream &err) const
 {
-    double nConstant = eAll(0); // get normalization constant
-    double final = 0; 
-    for (size_t i = 0; i < distribution.size() - 1; i++) { 
-        distribution[i].second = distribution[i].second/nConstant; // normalize
-        final += distribution[i].second; // add all values together
+    err << "Error: the evidence is impossible";
+    if (!options.logSpace) {
+        err << ", or too unlikely to tell without --log on";
     }
-    // get final value by subtracting sum from 1
-    distribution[distribution.size() - 1].second = 1 - final; 
+    err << "\n";
 }
 /*
  * printDistribution()
  * Purpose:     print values in distribution
- * Parameters:  none
+ * Parameters:  stream, variable, its distribution (may be empty) and the
+ *              standard error of each value (empty if exact)
  * Returns:     none
  */
-void Inference::printDistribution() 
+void Inference::printDistribution(ostream &out, int var,
+                                  const vector<double> &dist,
+                                  const vector<double> &error) const
 {
-    for (size_t i = 0; i < distribution.size(); i++) {
-        cout << "P(" <<  distribution[i].first << ") = "; 
-        cout << setprecision(digits(distribution[i].second)) << distribution[i].second;
-        if (i != distribution.size() - 1) {
-            cout << ", ";
+    for (size_t i = 0; i < dist.size(); i++) {
+        out << "P(" <<  model.getValueName(var, i) << ") = "; 
+        out << setprecision(digits(dist[i])) << dist[i];
+        if (i < error.size()) {
+            out << " +/- " << setprecision(2) << error[i];
         }
+        if (i != dist.size() - 1) {
+            out << ", ";
+        }
+    }
+    out << "\n\n";
+}
+/*
+ * printMemory()
+ * Purpose:     prints the model's memory footprint and the resident memory
+ *              of the whole process
+ * Parameters:  stream
+ * Returns:     none
+ */
+void Inference::printMemory(ostream &out) const
+{
+    model.footprint(out);
+    ifstream statm("/proc/self/statm"); // sizes in pages
+    long pages = 0, resident = 0;
+    if (statm >> pages >> resident) {
+        out << "Process resident: "
+            << Model::showSize(resident * sysconf(_SC_PAGESIZE)) << "\n";
     }
-    cout << "\n\n";
+    out << "\n";
 }
 /*
  * digits()
@@ -206,7 +841,7 @@ void Inference::printDistribution()
  * Parameters:  number for print
  * Returns:     number of digits to print
  */
-int Inference::digits(double num) {
+int Inference::digits(double num) const {
     string s = to_string(num);
     if ((s[2] == '0') and (s[3] != '0') and (s[5] != '0')) { // for 0.0##0 case
         return 2;
@@ -215,14 +850,3 @@ int Inference::digits(double num) {
     }
     return 3;
 }
-/*
- * reset()
- * Purpose:     resets instance for new query
- * Parameters:  none
- * Returns:     none
- */
-void Inference::reset() {
-    distribution.clear();
-    evidence.clear();
-    BayesNet.reset();
-}
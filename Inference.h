@@ -3,44 +3,107 @@
  * by: Valerie Zhang
  *
  * Purpose: Asks for user query and evidence, and returns probabilities based 
- *          on the information in the Bayes Network(BN)
+ *          on the information in the Bayes Network
  */
 #ifndef _INFERENCE_H_
 #define _INFERENCE_H_
-#include "CPT.h"
-#include "Node.h"
-#include "BN.h"
+#include "Model.h"
+#include "Engine.h"
+#include "Ordering.h"
+#include "ResultCache.h"
+#include "WorkStealingPool.h"
+#include "Stats.h"
+#include <iostream>
 #include <string>
 #include <queue>
 #include <utility>
 #include <sstream>
 #include <fstream>
 #include <iomanip>
+#include <thread>
 
 using namespace std;
 
+/* command line settings */
+struct Options {
+    string engine;        // "enum", "ve", "jt", "rc", "ac", "lw" or "gibbs"
+    Heuristic heuristic;  // elimination ordering for "ve", "jt", "rc", "ac"
+    size_t cacheSize;     // results kept by the LRU cache, 0 to disable
+    size_t cacheMB;       // memory "rc" may use to cache subproblems
+    bool prune;           // skip variables irrelevant to each query
+    bool logSpace;        // exact engines guard against underflow
+    long samples;         // most samples "lw" or "gibbs" draws per query
+    double targetError;   // sampling stops once its standard errors are below
+    int chains;           // Markov chains "gibbs" runs
+    uint64_t seed;        // seed of the sampling engines
+    string batchFile;     // answer the queries in this file, then exit
+    string scoreFile;     // answer one query per evidence row here, then exit
+    string compileFile;   // save the compiled model to this file, then exit
+    string circuitFile;   // "ac" loads its circuit from, or saves it to, here
+    string serveAddress;  // answer queries on this socket path or port
+    int threads;          // worker threads: one query each in batch and
+                          // server mode, a block of rows each in score
+                          // mode, otherwise shared by each enum query
+    bool quiet;           // no "Loading file" message
+    bool stats;           // print statistics after each query
+
+    Options() : engine("enum"), heuristic(MIN_FILL), cacheSize(1024),
+                cacheMB(64), prune(true), logSpace(false), samples(100000),
+                targetError(0), chains(4), seed(1),
+                threads(thread::hardware_concurrency()), quiet(false),
+                stats(false) {}
+};
+
 class Inference {
 public:
     Inference();
-    Inference(string filename);
+    Inference(string filename, Options opts);
     ~Inference();
 
+    void load(string filename);
+    void save(string filename) const;
+    bool setEngine(string name);
+    const Model &getModel() const { return model; }
+    QueryContext *newContext() const;
+    void ask(QueryContext &ctx, int var, const vector<int> &evidence,
+             vector<double> &dist);
+    void ask(int var, const vector<int> &evidence, vector<double> &dist);
     void run(); 
+    void runBatch(string filename, int threads);
+    void score(string filename, int threads);
+    void serve(string address, int threads);
 private:
-    BN BayesNet;
-    vector<pair <string, double>> distribution;
-    vector<pair <string, string>> evidence;
-    vector<string> vars;
+    Model model;
+    Options options;
+    Engine *engine;        // shared by every thread, never changed by a query
+    QueryContext *context; // state of the prompt's queries
+    WorkStealingPool *splitPool; // splits single queries, NULL in batch,
+                                 // score and server mode
+    ResultCache cache;
+    vector<int> observed; // evidence set with observe, under every query
 
-    string getQueryAndEvidence(string input);
-    void eAsk(string query);
-    bool inEvidence(string var);
-    string determineKey(string var);
-    double eAll(size_t count);
-    double summation(string var, size_t count);
-    void normalize();
-    void printDistribution();
-    int digits(double num);
-    void reset();
+    Engine *makeEngine(string name) const;
+    bool command(string input);
+    bool observe(string input, bool retract);
+    void printObserved(ostream &out) const;
+    void answer(QueryContext &ctx, string input, ostream &out, ostream &err);
+    string getQueryAndEvidence(string input, vector<int> &evidence) const;
+    bool readScoreHeader(string line, int &query, vector<int> &vars) const;
+    bool readScoreRow(string line, const vector<int> &vars,
+                      vector<int> &values) const;
+    void eAsk(QueryContext &ctx, int var, const vector<int> &evidence,
+              vector<double> &dist);
+    void infer(QueryContext &ctx, int var, const vector<int> &evidence,
+               vector<double> &dist);
+    void askAll(QueryContext &ctx, const vector<int> &evidence, ostream &out,
+                ostream &err);
+    void explain(string input, const vector<int> &evidence, ostream &out,
+                 ostream &err) const;
+    bool normalize(vector<double> &dist) const;
+    void impossible(ostream &err) const;
+    void printDistribution(ostream &out, int var, const vector<double> &dist,
+                           const vector<double> &error) const;
+    void printMemory(ostream &out) const;
+    int digits(double num) const;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,359 @@
+/*
+ * InferenceBench.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: Benchmark suite for the inference engines. Generates networks
+ *          of each shape and several sizes, then times loading each one
+ *          (as text and compiled), building each engine on it, and the
+ *          latency of answering the same random queries with each engine.
+ *          Results go to stdout as CSV, one row per measurement:
+ *              kind,network,vars,edges,engine,runs,mean_us,p50_us,
+ *              p90_us,p99_us,max_us,per_sec
+ *          where kind is load_text, load_bnb, setup or query. Given the
+ *          CSV of an earlier build with --baseline, rows whose median got
+ *          slower by more than the tolerance are reported on stderr and
+ *          the exit status is 1.
+ *
+ *          Build and run with: make bench [BENCH_ARGS="--quick"]
+ */
+#include "Inference.h"
+#include "Generator.h"
+#include "Random.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+/* one network of the suite */
+struct Network {
+    string shape;       // "chain", "polytree", "grid" or "dag"
+    int vars;           // or rows of a grid
+    int cols;           // of a grid
+    int inDegree;
+    int window;
+    int minArity, maxArity;
+    bool quick;         // part of the --quick suite
+};
+
+static const Network SUITE[] = {
+    {"dag",      15,  0, 2,  0, 2, 2, true},
+    {"chain",    100, 0, 0,  0, 2, 3, true},
+    {"chain",    1000, 0, 0, 0, 2, 3, false},
+    {"chain",    10000, 0, 0, 0, 2, 3, false},
+    {"polytree", 100, 0, 3,  0, 2, 3, true},
+    {"polytree", 1000, 0, 3, 0, 2, 3, false},
+    {"polytree", 10000, 0, 3, 0, 2, 3, false},
+    {"grid",     5,   5, 0,  0, 2, 2, true},
+    {"grid",     10,  10, 0, 0, 2, 2, false},
+    {"grid",     15,  15, 0, 0, 2, 2, false},
+    {"dag",      50,  0, 3, 10, 2, 3, true},
+    {"dag",      200, 0, 3, 10, 2, 3, false},
+    {"dag",      1000, 0, 3, 10, 2, 3, false},
+};
+static const int SUITE_SIZE = sizeof(SUITE) / sizeof(SUITE[0]);
+
+/* enumeration is exponential in the network, so it only runs on small ones */
+static const int ENUM_MAX_VARS = 20;
+static const int LOAD_RUNS = 5;
+static const int SETUP_RUNS = 5;
+static const double MIN_SLOWDOWN_US = 20; // smaller changes are noise
+
+/* timings of one measurement */
+struct Result {
+    string kind, network, engine;
+    int vars, edges;
+    vector<double> us; // microseconds of each run
+    double seconds;    // of all the runs together
+};
+
+static void usage() {
+    cerr << "Usage: ./inference_bench [--quick] [--queries n] "
+         << "[--budget seconds]\n"
+         << "       [--engines e1,e2,...] [--samples n] [--threads n] "
+         << "[--seed n]\n"
+         << "       [--dir tmpdir] [--baseline old.csv] "
+         << "[--tolerance fraction]\n";
+    exit(EXIT_FAILURE);
+}
+/*
+ * elapsedUS()
+ * Purpose:     microseconds since a time
+ */
+static double elapsedUS(Clock::time_point start)
+{
+    return chrono::duration<double, micro>(Clock::now() - start).count();
+}
+/*
+ * percentile()
+ * Purpose:     nearest-rank percentile of sorted timings
+ * Parameters:  sorted timings and fraction
+ * Returns:     timing
+ */
+static double percentile(const vector<double> &sorted, double p)
+{
+    size_t rank = (size_t)ceil(p * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+/*
+ * print()
+ * Purpose:     prints a measurement as a CSV row
+ * Parameters:  result; its timings get sorted
+ * Returns:     median, in microseconds
+ */
+static double print(Result &r)
+{
+    sort(r.us.begin(), r.us.end());
+    double sum = 0;
+    for (size_t i = 0; i < r.us.size(); i++) {
+        sum += r.us[i];
+    }
+    double median = percentile(r.us, 0.5);
+    printf("%s,%s,%d,%d,%s,%zu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+           r.kind.c_str(), r.network.c_str(), r.vars, r.edges,
+           r.engine.c_str(), r.us.size(), sum / r.us.size(), median,
+           percentile(r.us, 0.9), percentile(r.us, 0.99), r.us.back(),
+           r.us.size() / r.seconds);
+    fflush(stdout);
+    return median;
+}
+/*
+ * generate()
+ * Purpose:     writes a network of the suite to a file
+ * Parameters:  network, file and generator to fill
+ * Returns:     name of the network
+ */
+static string generate(const Network &n, const string &path, Generator &g)
+{
+    string name = n.shape + "-" + to_string(n.vars);
+    if (n.shape == "chain") {
+        g.chain(n.vars);
+    } else if (n.shape == "polytree") {
+        g.polytree(n.vars, n.inDegree);
+    } else if (n.shape == "grid") {
+        g.grid(n.vars, n.cols);
+        name += "x" + to_string(n.cols);
+    } else {
+        g.dag(n.vars, n.inDegree, n.window);
+    }
+    ofstream out(path);
+    if (!out.is_open()) {
+        cerr << "Error: could not write " << path << "\n";
+        exit(EXIT_FAILURE);
+    }
+    g.write(out);
+    return name;
+}
+/*
+ * makeQueries()
+ * Purpose:     picks random queries: a variable and up to three other
+ *              variables of evidence with random values
+ * Parameters:  model, number of queries, seed, and the query variables
+ *              and evidence to fill
+ * Returns:     none
+ */
+static void makeQueries(const Model &model, int count, uint64_t seed,
+                        vector<int> &vars, vector<vector<int>> &evidence)
+{
+    Random rng(seed);
+    int n = model.numVars();
+    for (int q = 0; q < count; q++) {
+        int var = rng.next() % n;
+        vector<int> e(n, NONE);
+        int given = min((int)(rng.next() % 4), n - 1);
+        for (int k = 0; k < given; k++) {
+            int v = rng.next() % n;
+            if (v == var) {continue;}
+            e[v] = rng.next() % model.getNumVal(v);
+        }
+        vars.push_back(var);
+        evidence.push_back(e);
+    }
+}
+/*
+ * readBaseline()
+ * Purpose:     reads the medians of an earlier run
+ * Parameters:  CSV file and map to fill, keyed by kind, network and engine
+ * Returns:     none
+ */
+static void readBaseline(const string &filename, map<string, double> &medians)
+{
+    ifstream in(filename);
+    if (!in.is_open()) {
+        cerr << "Error: could not open " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    string line;
+    getline(in, line); // header
+    while (getline(in, line)) {
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 12) {continue;}
+        medians[fields[0] + "," + fields[1] + "," + fields[4]] =
+            atof(fields[7].c_str());
+    }
+}
+/*
+ * compare()
+ * Purpose:     reports a measurement whose median got slower than the
+ *              baseline's by more than the tolerance
+ * Parameters:  result, its median, baseline medians and tolerance
+ * Returns:     true if it regressed
+ */
+static bool compare(const Result &r, double median,
+                    const map<string, double> &baseline, double tolerance)
+{
+    map<string, double>::const_iterator it =
+        baseline.find(r.kind + "," + r.network + "," + r.engine);
+    if (it == baseline.end()) {return false;}
+    double old = it->second;
+    if (median <= old * (1 + tolerance) or median - old < MIN_SLOWDOWN_US) {
+        return false;
+    }
+    fprintf(stderr, "Regression: %s %s %s median %.1fus -> %.1fus (+%.0f%%)\n",
+            r.kind.c_str(), r.network.c_str(), r.engine.c_str(), old, median,
+            100 * (median / old - 1));
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    bool quick = false;
+    int numQueries = 200;
+    double budget = 2;
+    string engineList = "enum,ve,jt,rc,ac,lw,gibbs";
+    string dir = "/tmp", baselineFile;
+    double tolerance = 0.25;
+    uint64_t seed = 1;
+    Options opts;
+    opts.quiet = true;
+    opts.cacheSize = 0; // time the engines, not the cache
+    opts.samples = 10000;
+    opts.threads = 1;
+    for (int a = 1; a < argc; a++) {
+        string flag = argv[a];
+        if (flag == "--quick") {
+            quick = true;
+            continue;
+        }
+        if (a + 1 == argc) {usage();}
+        string arg = argv[++a];
+        if (flag == "--queries") {
+            numQueries = atoi(arg.c_str());
+        } else if (flag == "--budget") {
+            budget = atof(arg.c_str());
+        } else if (flag == "--engines") {
+            engineList = arg;
+        } else if (flag == "--samples") {
+            opts.samples = atol(arg.c_str());
+        } else if (flag == "--threads") {
+            opts.threads = atoi(arg.c_str());
+        } else if (flag == "--seed") {
+            seed = strtoull(arg.c_str(), NULL, 10);
+        } else if (flag == "--dir") {
+            dir = arg;
+        } else if (flag == "--baseline") {
+            baselineFile = arg;
+        } else if (flag == "--tolerance") {
+            tolerance = atof(arg.c_str());
+        } else {
+            usage();
+        }
+    }
+    if (numQueries < 1) {usage();}
+    vector<string> engines;
+    stringstream ss(engineList);
+    string name;
+    while (getline(ss, name, ',')) {
+        engines.push_back(name);
+    }
+    map<string, double> baseline;
+    if (!baselineFile.empty()) {readBaseline(baselineFile, baseline);}
+
+    printf("kind,network,vars,edges,engine,runs,mean_us,p50_us,p90_us,"
+           "p99_us,max_us,per_sec\n");
+    int regressions = 0;
+    for (int i = 0; i < SUITE_SIZE; i++) {
+        const Network &n = SUITE[i];
+        if (quick and !n.quick) {continue;}
+        Generator g(n.minArity, n.maxArity, seed + i);
+        string text = dir + "/bench-" + to_string(i) + ".txt";
+        string compiled = dir + "/bench-" + to_string(i) + ".bnb";
+        Result r;
+        r.network = generate(n, text, g);
+        r.vars = g.numVars();
+        r.edges = g.numEdges();
+        cerr << "Benchmarking " << r.network << "\n";
+
+        opts.engine = "enum"; // loading also builds the engine; this one is free
+        Inference inference(text, opts);
+        inference.save(compiled);
+        const string files[] = {text, compiled};
+        const char *kinds[] = {"load_text", "load_bnb"};
+        for (int f = 0; f < 2; f++) {
+            r.kind = kinds[f];
+            r.engine = "";
+            r.us.clear();
+            Clock::time_point all = Clock::now();
+            for (int run = 0; run < LOAD_RUNS; run++) {
+                Clock::time_point start = Clock::now();
+                inference.load(files[f]);
+                r.us.push_back(elapsedUS(start));
+            }
+            r.seconds = elapsedUS(all) / 1e6;
+            regressions += compare(r, print(r), baseline, tolerance);
+        }
+
+        vector<int> vars;
+        vector<vector<int>> evidence;
+        makeQueries(inference.getModel(), numQueries, seed + i, vars, evidence);
+        for (size_t e = 0; e < engines.size(); e++) {
+            if (engines[e] == "enum" and r.vars > ENUM_MAX_VARS) {continue;}
+            r.engine = engines[e];
+            r.kind = "setup";
+            r.us.clear();
+            Clock::time_point all = Clock::now();
+            for (int run = 0; run < SETUP_RUNS; run++) {
+                Clock::time_point start = Clock::now();
+                if (!inference.setEngine(engines[e])) {
+                    cerr << "Error: unknown engine " << engines[e] << "\n";
+                    exit(EXIT_FAILURE);
+                }
+                r.us.push_back(elapsedUS(start));
+            }
+            r.seconds = elapsedUS(all) / 1e6;
+            regressions += compare(r, print(r), baseline, tolerance);
+
+            // every engine answers the same queries, in order, until they
+            // run out or the time budget does
+            r.kind = "query";
+            r.us.clear();
+            vector<double> dist;
+            // gibbs warns whenever a short run does not mix; mute that
+            streambuf *errors = cerr.rdbuf(NULL);
+            all = Clock::now();
+            for (int q = 0; q < numQueries and
+                 (q == 0 or elapsedUS(all) < budget * 1e6); q++) {
+                Clock::time_point one = Clock::now();
+                inference.ask(vars[q], evidence[q], dist);
+                r.us.push_back(elapsedUS(one));
+            }
+            r.seconds = elapsedUS(all) / 1e6;
+            cerr.rdbuf(errors);
+            cerr.clear();
+            regressions += compare(r, print(r), baseline, tolerance);
+        }
+    }
+    if (regressions > 0) {
+        cerr << regressions << " measurements regressed\n";
+        return 1;
+    }
+    return 0;
+}
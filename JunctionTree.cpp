@@ -0,0 +1,360 @@
+/*
+ * JunctionTree.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of JunctionTree class.
+ */
+#include "JunctionTree.h"
+#include <algorithm>
+
+using namespace std;
+
+/*
+ * constructor
+ */
+JunctionTree::JunctionTree(const Model &m, Heuristic h) : Engine(m)
+{
+    build(h);
+}
+/*
+ * build()
+ * Purpose:     triangulates the moral graph, joins the elimination cliques
+ *              into a tree and gives each CPT to a clique holding its family
+ * Parameters:  elimination ordering heuristic
+ * Returns:     none
+ */
+void JunctionTree::build(Heuristic h)
+{
+    int n = model.numVars();
+    vector<bool> all(n, true);
+    vector<int> order = eliminationOrder(model, all, all, h);
+    vector<vector<int>> elim = eliminationCliques(model, order);
+    vector<int> position(n);
+    for (int i = 0; i < n; i++) {
+        position[order[i]] = i;
+    }
+
+    // clique i hangs off the clique of the first of its other variables
+    // to be eliminated
+    vector<int> par(n, NONE);
+    vector<vector<int>> ch(n);
+    for (int i = 0; i < n; i++) {
+        for (size_t k = 1; k < elim[i].size(); k++) {
+            int p = position[elim[i][k]];
+            if (par[i] == NONE or p < par[i]) {par[i] = p;}
+        }
+        if (par[i] != NONE) {ch[par[i]].push_back(i);}
+        sort(elim[i].begin(), elim[i].end());
+    }
+
+    // fold each clique that is a subset of one of its children into it
+    vector<int> rep(n, NONE);
+    for (int i = 0; i < n; i++) {
+        int into = NONE;
+        for (size_t k = 0; k < ch[i].size() and into == NONE; k++) {
+            int j = ch[i][k];
+            if (includes(elim[j].begin(), elim[j].end(),
+                         elim[i].begin(), elim[i].end())) {
+                into = j;
+            }
+        }
+        if (into == NONE) {continue;}
+        rep[i] = into;
+        par[into] = par[i];
+        for (size_t k = 0; k < ch[i].size(); k++) {
+            if (ch[i][k] != into) {
+                par[ch[i][k]] = into;
+                ch[into].push_back(ch[i][k]);
+            }
+        }
+        if (par[i] != NONE) {
+            replace(ch[par[i]].begin(), ch[par[i]].end(), i, into);
+        }
+    }
+
+    // number the remaining cliques
+    vector<int> id(n, NONE);
+    for (int i = 0; i < n; i++) {
+        if (rep[i] == NONE) {
+            id[i] = cliques.size();
+            cliques.push_back(elim[i]);
+        }
+    }
+    int k = cliques.size();
+    parent.assign(k, NONE);
+    kids.assign(k, vector<int>());
+    for (int i = 0; i < n; i++) {
+        if (rep[i] == NONE and par[i] != NONE) {
+            parent[id[i]] = id[par[i]];
+            kids[id[par[i]]].push_back(id[i]);
+        }
+    }
+    for (int c = 0; c < k; c++) {
+        if (parent[c] == NONE) {bfs.push_back(c);}
+    }
+    for (size_t i = 0; i < bfs.size(); i++) {
+        bfs.insert(bfs.end(), kids[bfs[i]].begin(), kids[bfs[i]].end());
+    }
+    root.assign(k, NONE);
+    for (int i = 0; i < k; i++) {
+        int c = bfs[i];
+        root[c] = parent[c] == NONE ? c : root[parent[c]];
+    }
+
+    // the first family member eliminated has the whole family in its clique
+    initial.assign(k, Factor());
+    home.assign(n, NONE);
+    for (int v = 0; v < n; v++) {
+        int c = position[v];
+        for (int i = 0; i < model.getNumParents(v); i++) {
+            c = min(c, position[model.getParents(v)[i]]);
+        }
+        while (rep[c] != NONE) {c = rep[c];}
+        home[v] = id[c];
+        initial[id[c]] = initial[id[c]].product(Factor(model, v));
+    }
+    holders.assign(n, vector<int>());
+    for (int v = 0; v < n; v++) {
+        holders[v].push_back(home[v]);
+        for (int i = 0; i < model.getNumParents(v); i++) {
+            holders[model.getParents(v)[i]].push_back(home[v]);
+        }
+    }
+}
+/*
+ * separator()
+ * Purpose:     variables a clique shares with its parent
+ * Parameters:  clique
+ * Returns:     shared variables
+ */
+vector<int> JunctionTree::separator(int c) const
+{
+    vector<int> sep;
+    const vector<int> &a = cliques[c];
+    const vector<int> &b = cliques[parent[c]];
+    set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                     back_inserter(sep));
+    return sep;
+}
+/*
+ * absorb()
+ * Purpose:     reduces the potentials of the cliques whose CPTs mention a
+ *              variable whose evidence changed, and marks stale every
+ *              message and belief that depends on them. An up message is
+ *              stale once anything below it changed; a down message unless
+ *              everything that changed is below it.
+ * Parameters:  context and evidence
+ * Returns:     none
+ */
+void JunctionTree::absorb(Context &ctx, const vector<int> &evidence) const
+{
+    int k = cliques.size();
+    if (!ctx.calibrated) {
+        ctx.pot.assign(k, Factor());
+        for (int c = 0; c < k; c++) {
+            ctx.pot[c] = initial[c].reduce(evidence);
+        }
+        ctx.up.assign(k, Factor());
+        ctx.down.assign(k, Factor()); // a root's stays empty
+        ctx.beliefs.assign(k, Factor());
+        ctx.upValid.assign(k, false);
+        ctx.beliefValid.assign(k, false);
+        ctx.downValid.assign(k, false);
+        for (int c = 0; c < k; c++) {
+            if (parent[c] == NONE) {ctx.downValid[c] = true;}
+        }
+        ctx.total.assign(k, 0);
+        ctx.totalValid.assign(k, false);
+        ctx.absorbed = evidence;
+        observe(ctx, evidence);
+        ctx.calibrated = true;
+        return;
+    }
+    vector<int> changed;
+    for (int v = 0; v < model.numVars(); v++) {
+        if (evidence[v] != ctx.absorbed[v]) {
+            changed.insert(changed.end(), holders[v].begin(), holders[v].end());
+        }
+    }
+    if (changed.empty()) {return;}
+    sort(changed.begin(), changed.end());
+    changed.erase(unique(changed.begin(), changed.end()), changed.end());
+
+    vector<int> below(k, 0);   // changed cliques in each clique's subtree
+    vector<int> inTree(k, 0);  // changed cliques in each tree, by root
+    for (size_t i = 0; i < changed.size(); i++) {
+        int c = changed[i];
+        ctx.pot[c] = initial[c].reduce(evidence);
+        inTree[root[c]]++;
+        for (int x = c; x != NONE; x = parent[x]) {
+            below[x]++;
+            ctx.upValid[x] = false;
+        }
+    }
+    for (int c = 0; c < k; c++) {
+        if (inTree[root[c]] == 0) {continue;} // another tree, untouched
+        ctx.beliefValid[c] = false;
+        ctx.totalValid[root[c]] = false;
+        if (below[c] != inTree[root[c]]) {ctx.downValid[c] = false;}
+    }
+    ctx.absorbed = evidence;
+    observe(ctx, evidence);
+}
+/*
+ * observe()
+ * Purpose:     finds the trees that hold evidence, the only ones whose
+ *              totals can be 0
+ * Parameters:  context and evidence
+ * Returns:     none
+ */
+void JunctionTree::observe(Context &ctx, const vector<int> &evidence) const
+{
+    ctx.observed.clear();
+    for (int v = 0; v < model.numVars(); v++) {
+        if (evidence[v] == NONE) {continue;}
+        for (size_t j = 0; j < holders[v].size(); j++) {
+            ctx.observed.push_back(root[holders[v][j]]);
+        }
+    }
+    sort(ctx.observed.begin(), ctx.observed.end());
+    ctx.observed.erase(unique(ctx.observed.begin(), ctx.observed.end()),
+                       ctx.observed.end());
+}
+/*
+ * possible()
+ * Purpose:     checks that no tree holding evidence sums to 0 under it,
+ *              computing the stale totals from their roots' beliefs; the
+ *              query's own tree alone misses a contradiction in another
+ * Parameters:  context
+ * Returns:     false if the evidence is impossible (or underflowed)
+ */
+bool JunctionTree::possible(Context &ctx) const
+{
+    for (size_t i = 0; i < ctx.observed.size(); i++) {
+        int r = ctx.observed[i];
+        if (!ctx.totalValid[r]) {
+            const Factor &f = belief(ctx, r);
+            double sum = 0;
+            for (int j = 0; j < f.size(); j++) {sum += f.getValue(j);}
+            ctx.total[r] = sum;
+            ctx.totalValid[r] = true;
+        }
+        if (ctx.total[r] == 0) {return false;}
+    }
+    return true;
+}
+/*
+ * collect()
+ * Purpose:     recomputes the stale up messages of a clique's subtree,
+ *              children before parents, then the clique's own
+ * Parameters:  context and clique (not a root)
+ * Returns:     none
+ */
+void JunctionTree::collect(Context &ctx, int c) const
+{
+    vector<int> stack(1, c); // explicit, chains can be deep
+    while (!stack.empty()) {
+        int x = stack.back();
+        bool ready = true;
+        for (size_t j = 0; j < kids[x].size(); j++) {
+            if (!ctx.upValid[kids[x][j]]) {
+                stack.push_back(kids[x][j]);
+                ready = false;
+            }
+        }
+        if (!ready) {continue;}
+        stack.pop_back();
+        Factor f = ctx.pot[x];
+        for (size_t j = 0; j < kids[x].size(); j++) {
+            f = f.product(ctx.up[kids[x][j]]);
+        }
+        ctx.up[x] = f.marginal(separator(x));
+        if (logSpace) {ctx.up[x].rescale();} // beliefs are only proportional
+        ctx.upValid[x] = true;
+    }
+}
+/*
+ * distribute()
+ * Purpose:     recomputes the stale down messages on the path from the
+ *              root to a clique, top first
+ * Parameters:  context and clique
+ * Returns:     none
+ */
+void JunctionTree::distribute(Context &ctx, int c) const
+{
+    vector<int> path;
+    for (int x = c; !ctx.downValid[x]; x = parent[x]) {
+        path.push_back(x);
+    }
+    for (int i = (int)path.size() - 1; i >= 0; i--) {
+        int x = path[i];
+        int p = parent[x];
+        Factor f = ctx.pot[p].product(ctx.down[p]);
+        for (size_t j = 0; j < kids[p].size(); j++) {
+            int y = kids[p][j];
+            if (y == x) {continue;}
+            if (!ctx.upValid[y]) {collect(ctx, y);}
+            f = f.product(ctx.up[y]);
+        }
+        ctx.down[x] = f.marginal(separator(x));
+        if (logSpace) {ctx.down[x].rescale();}
+        ctx.downValid[x] = true;
+    }
+}
+/*
+ * belief()
+ * Purpose:     a clique's belief under the absorbed evidence, recomputing
+ *              it and the messages it needs if they are stale
+ * Parameters:  context and clique
+ * Returns:     the belief
+ */
+const Factor &JunctionTree::belief(Context &ctx, int c) const
+{
+    if (!ctx.beliefValid[c]) {
+        distribute(ctx, c);
+        Factor f = ctx.pot[c].product(ctx.down[c]);
+        for (size_t j = 0; j < kids[c].size(); j++) {
+            if (!ctx.upValid[kids[c][j]]) {collect(ctx, kids[c][j]);}
+            f = f.product(ctx.up[kids[c][j]]);
+        }
+        if (logSpace) {f.rescale();}
+        ctx.beliefs[c] = f;
+        ctx.beliefValid[c] = true;
+    }
+    return ctx.beliefs[c];
+}
+/*
+ * ask()
+ * Purpose:     reads the query's distribution off its clique's belief,
+ *              absorbing the evidence first if it changed
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
+ */
+void JunctionTree::ask(QueryContext &ctx, int query,
+                       const vector<int> &evidence,
+                       vector<double> &dist) const
+{
+    Context &c = static_cast<Context &>(ctx);
+    absorb(c, evidence);
+    dist.assign(model.getNumVal(query), 0);
+    if (!possible(c)) {return;}
+    Factor f = belief(c, home[query]).marginal(vector<int>(1, query));
+    for (int i = 0; i < f.size(); i++) {
+        dist[i] = f.getValue(i);
+    }
+}
+/*
+ * askAll()
+ * Purpose:     computes every posterior, sharing the messages between them
+ * Parameters:  context, evidence and the vectors to fill, one per
+ *              variable
+ * Returns:     none
+ */
+void JunctionTree::askAll(QueryContext &ctx, const vector<int> &evidence,
+                          vector<vector<double>> &dists) const
+{
+    dists.assign(model.numVars(), vector<double>());
+    for (int v = 0; v < model.numVars(); v++) {
+        if (evidence[v] == NONE) {ask(ctx, v, evidence, dists[v]);}
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * JunctionTree.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Junction tree (clique tree) inference. The tree is built once
+ *          from the Model, and each query context keeps the messages
+ *          between cliques from one of its queries to the next. When the
+ *          evidence changes, only the messages that carry the changed
+ *          cliques' potentials are marked stale, and a query recomputes
+ *          just the stale messages its clique needs: changing one
+ *          observation costs the messages on the path from that
+ *          observation to the query, not a whole calibration.
+ */
+#ifndef _JUNCTIONTREE_H_
+#define _JUNCTIONTREE_H_
+
+#include "Engine.h"
+#include "Factor.h"
+#include "Ordering.h"
+
+using namespace std;
+
+class JunctionTree : public Engine {
+public:
+    JunctionTree(const Model &m, Heuristic h);
+
+    QueryContext *newContext() const { return new Context(); }
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+    void askAll(QueryContext &ctx, const vector<int> &evidence,
+                vector<vector<double>> &dists) const;
+
+private:
+    /* the state of the last query, kept for the next; a message or belief
+       is only valid while its flag is set */
+    struct Context : public QueryContext {
+        bool calibrated;
+        vector<int> absorbed;    // evidence the potentials were reduced by
+        vector<Factor> pot;      // initial potentials reduced by it
+        vector<Factor> up;       // message from each clique to its parent
+        vector<Factor> down;     // message from the parent to each clique
+        vector<Factor> beliefs;
+        vector<bool> upValid, downValid, beliefValid;
+        vector<double> total;    // sum of each tree's belief, by root
+        vector<bool> totalValid;
+        vector<int> observed;    // roots of the trees holding evidence
+        Context() : calibrated(false) {}
+    };
+
+    vector<vector<int>> cliques; // variables in each clique
+    vector<int> parent;          // parent clique, NONE for a root
+    vector<vector<int>> kids;
+    vector<int> root;            // root of each clique's tree
+    vector<int> bfs;             // cliques ordered roots first
+    vector<Factor> initial;      // product of the CPTs given to each clique
+    vector<int> home;            // clique holding each variable's CPT
+    vector<vector<int>> holders; // cliques whose CPTs mention each variable
+
+    void build(Heuristic h);
+    void absorb(Context &ctx, const vector<int> &evidence) const;
+    void collect(Context &ctx, int c) const;
+    void distribute(Context &ctx, int c) const;
+    const Factor &belief(Context &ctx, int c) const;
+    void observe(Context &ctx, const vector<int> &evidence) const;
+    bool possible(Context &ctx) const;
+    vector<int> separator(int c) const;
+};
+#endif
@@ -0,0 +1,259 @@
+/*
+ * LikelihoodWeighting.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of LikelihoodWeighting class.
+ */
+#include "LikelihoodWeighting.h"
+#include "Random.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const int BATCH = 64;          // samples whose arrays are filled together
+static const long CHUNK = 8192;       // samples per task
+static const int CHUNKS_PER_ROUND = 8; // tasks between checks of the error
+
+/*
+ * constructor
+ */
+LikelihoodWeighting::LikelihoodWeighting(const Model &m, long samples,
+                                         double target, uint64_t s,
+                                         WorkStealingPool *p) : Engine(m)
+{
+    pool = p;
+    maxSamples = samples;
+    targetError = target;
+    seed = s;
+    valueStart.assign(1, 0);
+    for (int v = 0; v < model.numVars(); v++) {
+        valueStart.push_back(valueStart.back() + model.getNumVal(v));
+    }
+}
+/*
+ * ask()
+ * Purpose:     estimates the distribution of the query variable
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none; dist[i] estimates P(query = i, evidence)
+ */
+void LikelihoodWeighting::ask(QueryContext &ctx, int query,
+                              const vector<int> &evidence,
+                              vector<double> &dist) const
+{
+    vector<int> pruned = evidence;
+    if (!relevant(query, pruned, ctx.needed)) {
+        dist.assign(model.getNumVal(query), 0);
+        return;
+    }
+    Sums sums;
+    sample(ctx, pruned, vector<int>(1, query), sums);
+    ctx.errors.assign(model.numVars(), vector<double>());
+    estimate(ctx, query, sums, dist);
+}
+/*
+ * askAll()
+ * Purpose:     estimates every posterior from the same samples
+ * Parameters:  context, evidence and the vectors to fill, one per
+ *              variable
+ * Returns:     none
+ */
+void LikelihoodWeighting::askAll(QueryContext &ctx,
+                                 const vector<int> &evidence,
+                                 vector<vector<double>> &dists) const
+{
+    vector<int> targets;
+    for (int v = 0; v < model.numVars(); v++) {
+        if (evidence[v] == NONE) {targets.push_back(v);}
+    }
+    if (!possibleEvidence(model, evidence)) { // every posterior is all 0
+        dists.assign(model.numVars(), vector<double>());
+        for (size_t i = 0; i < targets.size(); i++) {
+            dists[targets[i]].assign(model.getNumVal(targets[i]), 0);
+        }
+        return;
+    }
+    ctx.needed.assign(model.numVars(), true);
+    Sums sums;
+    sample(ctx, evidence, targets, sums);
+    ctx.errors.assign(model.numVars(), vector<double>());
+    dists.assign(model.numVars(), vector<double>());
+    for (size_t i = 0; i < targets.size(); i++) {
+        estimate(ctx, targets[i], sums, dists[targets[i]]);
+    }
+}
+/*
+ * sample()
+ * Purpose:     draws rounds of sample chunks until the sample budget is
+ *              spent or every target's standard error is small enough
+ * Parameters:  context, evidence, variables to estimate and totals to
+ *              fill
+ * Returns:     none
+ *
+ * Chunk k always uses random stream k and the chunks are added in order,
+ * so the estimate is the same however many threads drew it.
+ */
+void LikelihoodWeighting::sample(QueryContext &ctx,
+                                 const vector<int> &evidence,
+                                 const vector<int> &targets, Sums &sums) const
+{
+    vector<int> order; // needed variables, parents first
+    for (int i = 0; i < model.numVars(); i++) {
+        int v = model.getOrder()[i];
+        if (ctx.needed[v]) {order.push_back(v);}
+    }
+    sums.weight.assign(valueStart.back(), 0);
+    sums.squared.assign(valueStart.back(), 0);
+    long &drawn = sums.count;
+    uint64_t stream = 0;
+    while (drawn < maxSamples) {
+        vector<Sums> part(CHUNKS_PER_ROUND);
+        WorkStealingPool::Group group;
+        int chunks = 0;
+        for (; chunks < CHUNKS_PER_ROUND and drawn < maxSamples; chunks++) {
+            long count = min(CHUNK, maxSamples - drawn);
+            drawn += count;
+            Sums &out = part[chunks];
+            if (pool == NULL) {
+                sampleChunk(order, evidence, targets, count, stream++, out);
+                continue;
+            }
+            pool->spawn(group, [this, &order, &evidence, &targets, count,
+                                stream, &out]() {
+                sampleChunk(order, evidence, targets, count, stream, out);
+            });
+            stream++;
+        }
+        if (pool != NULL) {pool->wait(group);}
+        for (int c = 0; c < chunks; c++) {
+            sums.total += part[c].total;
+            sums.totalSquared += part[c].totalSquared;
+            for (size_t i = 0; i < targets.size(); i++) {
+                for (int k = valueStart[targets[i]];
+                     k < valueStart[targets[i] + 1]; k++) {
+                    sums.weight[k] += part[c].weight[k];
+                    sums.squared[k] += part[c].squared[k];
+                }
+            }
+        }
+        if (targetError <= 0 or sums.total <= 0) {continue;}
+        bool done = true;
+        for (size_t i = 0; i < targets.size() and done; i++) {
+            vector<double> dist;
+            estimate(ctx, targets[i], sums, dist);
+            const vector<double> &err = ctx.errors[targets[i]];
+            done = *max_element(err.begin(), err.end()) <= targetError;
+        }
+        if (done) {break;}
+    }
+}
+/*
+ * sampleChunk()
+ * Purpose:     draws weighted samples and adds up their weights
+ * Parameters:  variables to sample in topological order, evidence,
+ *              variables to estimate, number of samples, random stream
+ *              and totals to fill
+ * Returns:     none
+ */
+void LikelihoodWeighting::sampleChunk(const vector<int> &order,
+                                      const vector<int> &evidence,
+                                      const vector<int> &targets, long count,
+                                      uint64_t stream, Sums &sums) const
+{
+    Random rng(seed, stream);
+    int n = model.numVars();
+    // values[v * BATCH + b] is the value of v in sample b of the batch
+    vector<int> values(n * BATCH);
+    for (int v = 0; v < n; v++) {
+        if (evidence[v] != NONE) {
+            fill(values.begin() + v * BATCH, values.begin() + (v + 1) * BATCH,
+                 evidence[v]);
+        }
+    }
+    sums.weight.assign(valueStart.back(), 0);
+    sums.squared.assign(valueStart.back(), 0);
+    int row[BATCH];      // first CPT entry of each sample's row
+    double weight[BATCH];
+    double u[BATCH];
+    double below[BATCH]; // probability of the values below the current one
+    for (long done = 0; done < count; done += BATCH) {
+        int m = min((long)BATCH, count - done);
+        fill(weight, weight + BATCH, 1.0);
+        for (size_t j = 0; j < order.size(); j++) {
+            int v = order[j];
+            int card = model.getNumVal(v);
+            const double *cpt = model.getCPT(v);
+            const int *parents = model.getParents(v);
+            const int *strides = model.getStrides(v);
+            int *x = &values[v * BATCH];
+            fill(row, row + m, 0);
+            for (int i = 0; i < model.getNumParents(v); i++) {
+                const int *px = &values[parents[i] * BATCH];
+                int step = strides[i] * card;
+                for (int b = 0; b < m; b++) {
+                    row[b] += px[b] * step;
+                }
+            }
+            if (evidence[v] != NONE) { // weight by the evidence
+                int e = evidence[v];
+                for (int b = 0; b < m; b++) {
+                    weight[b] *= cpt[row[b] + e];
+                }
+                continue;
+            }
+            for (int b = 0; b < m; b++) {
+                u[b] = rng.uniform();
+                below[b] = 0;
+                x[b] = 0;
+            }
+            for (int k = 0; k < card - 1; k++) { // invert the CDF
+                for (int b = 0; b < m; b++) {
+                    below[b] += cpt[row[b] + k];
+                    x[b] += (u[b] >= below[b]);
+                }
+            }
+        }
+        for (int b = 0; b < m; b++) {
+            sums.total += weight[b];
+            sums.totalSquared += weight[b] * weight[b];
+        }
+        for (size_t i = 0; i < targets.size(); i++) {
+            const int *x = &values[targets[i] * BATCH];
+            double *w = &sums.weight[valueStart[targets[i]]];
+            double *w2 = &sums.squared[valueStart[targets[i]]];
+            for (int b = 0; b < m; b++) {
+                w[x[b]] += weight[b];
+                w2[x[b]] += weight[b] * weight[b];
+            }
+        }
+    }
+}
+/*
+ * estimate()
+ * Purpose:     reads a variable's distribution and the standard errors of
+ *              its normalized probabilities off the sample totals
+ * Parameters:  context to keep the errors in, variable, totals and
+ *              distribution to fill
+ * Returns:     none
+ *
+ * The posterior is a ratio of two sample means, so its variance comes from
+ * the delta method: sum of w^2 (1[x = i] - p)^2 over (sum of w)^2.
+ */
+void LikelihoodWeighting::estimate(QueryContext &ctx, int var,
+                                   const Sums &sums,
+                                   vector<double> &dist) const
+{
+    vector<vector<double>> &errors = ctx.errors;
+    int card = model.getNumVal(var);
+    dist.assign(card, 0);
+    if (errors.empty()) {errors.assign(model.numVars(), vector<double>());}
+    errors[var].assign(card, 0);
+    for (int i = 0; i < card; i++) {
+        int k = valueStart[var] + i;
+        dist[i] = sums.weight[k] / sums.count; // mean weight estimates P(xi,e)
+        if (sums.total <= 0) {continue;}
+        double p = sums.weight[k] / sums.total;
+        double var2 = sums.squared[k] * (1 - 2 * p) + p * p * sums.totalSquared;
+        errors[var][i] = sqrt(max(var2, 0.0)) / sums.total;
+    }
+}
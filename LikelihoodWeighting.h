@@ -0,0 +1,57 @@
+/*
+ * LikelihoodWeighting.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Approximate inference by likelihood weighting. Samples are drawn
+ *          in topological order with the evidence clamped, and each is
+ *          weighted by the probability of the evidence given its parents.
+ *          Samples are drawn in batches stored one array per variable, so
+ *          the CPT lookups and weight products run down whole arrays. With
+ *          a WorkStealingPool, chunks of samples run as parallel tasks.
+ */
+#ifndef _LIKELIHOODWEIGHTING_H_
+#define _LIKELIHOODWEIGHTING_H_
+
+#include "Engine.h"
+#include "WorkStealingPool.h"
+#include <stdint.h>
+
+using namespace std;
+
+class LikelihoodWeighting : public Engine {
+public:
+    LikelihoodWeighting(const Model &m, long samples, double targetError,
+                        uint64_t seed, WorkStealingPool *p = NULL);
+
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+    void askAll(QueryContext &ctx, const vector<int> &evidence,
+                vector<vector<double>> &dists) const;
+    bool exact() const { return false; }
+
+private:
+    /* weight totals of a set of samples */
+    struct Sums {
+        vector<double> weight;  // of samples with each value of the targets
+        vector<double> squared; // the same, of squared weights
+        double total;
+        double totalSquared;
+        long count;             // samples drawn
+        Sums() : total(0), totalSquared(0), count(0) {}
+    };
+
+    WorkStealingPool *pool; // NULL to run serially
+    long maxSamples;
+    double targetError;     // stop once every standard error is below, or 0
+    uint64_t seed;
+    vector<int> valueStart; // first entry of each variable in the sums
+
+    void sample(QueryContext &ctx, const vector<int> &evidence,
+                const vector<int> &targets, Sums &sums) const;
+    void sampleChunk(const vector<int> &order, const vector<int> &evidence,
+                     const vector<int> &targets, long count, uint64_t stream,
+                     Sums &sums) const;
+    void estimate(QueryContext &ctx, int var, const Sums &sums,
+                  vector<double> &dist) const;
+};
+#endif
@@ -0,0 +1,78 @@
+/*
+ * LogSpace.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Arithmetic on logarithms of probabilities, for engines that
+ *          would otherwise multiply hundreds of probabilities into a
+ *          double that underflows to 0. The build uses -Ofast, which
+ *          assumes there are no infinities, so log 0 is LOG_ZERO, a finite
+ *          number far below any real log probability.
+ */
+#ifndef _LOGSPACE_H_
+#define _LOGSPACE_H_
+
+#include "FactorKernels.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const double LOG_ZERO = -1e300;
+
+/*
+ * logOf()
+ * Purpose:     log of a probability, LOG_ZERO for 0
+ */
+inline double logOf(double p) { return p > 0 ? log(p) : LOG_ZERO; }
+/*
+ * logTimes()
+ * Purpose:     log of the product of two probabilities given their logs;
+ *              anything times 0 stays LOG_ZERO rather than running off to
+ *              -infinity
+ */
+inline double logTimes(double a, double b) { return max(a + b, LOG_ZERO); }
+/*
+ * logPlus()
+ * Purpose:     log of the sum of two probabilities given their logs
+ */
+inline double logPlus(double a, double b)
+{
+    if (a < b) {swap(a, b);}
+    if (b <= LOG_ZERO) {return a;}
+    return a + log1p(exp(b - a));
+}
+/* log-sum-exp over terms that come one at a time, with no buffer: the sum
+   of every term over the largest so far, rescaled when a larger one comes */
+struct LogSum {
+    double top;
+    double sum;
+
+    LogSum() : top(LOG_ZERO), sum(0) {}
+    void add(double a)
+    {
+        if (a <= LOG_ZERO) {return;}
+        if (a > top) {
+            sum = sum * exp(top - a) + 1;
+            top = a;
+        } else {
+            sum += exp(a - top);
+        }
+    }
+    double value() const { return sum > 0 ? top + log(sum) : LOG_ZERO; }
+};
+/*
+ * logToLinear()
+ * Purpose:     turns the logs of an unnormalized distribution back into
+ *              probabilities in proportion, the largest becoming 1
+ * Parameters:  the distribution
+ * Returns:     none; every entry is left 0 if they all were LOG_ZERO
+ */
+inline void logToLinear(vector<double> &dist)
+{
+    if (dist.empty()) {return;}
+    double top = factorKernels().largest(dist.data(), dist.size());
+    for (size_t i = 0; i < dist.size(); i++) {
+        dist[i] = top <= LOG_ZERO ? 0 : exp(dist[i] - top);
+    }
+}
+#endif
@@ -0,0 +1,154 @@
+/*
+ * MaxProduct.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of MaxProduct class.
+ */
+#include "MaxProduct.h"
+#include <cmath>
+
+using namespace std;
+
+/*
+ * constructor
+ */
+MaxProduct::MaxProduct(const Model &m, Heuristic h, bool p) : model(m)
+{
+    heuristic = h;
+    prune = p;
+}
+/*
+ * solve()
+ * Purpose:     finds the most likely joint values of some variables given
+ *              evidence, summing over every other variable (all variables
+ *              that are not evidence: MPE; some of them: partial MAP)
+ * Parameters:  evidence, which variables to maximize (evidence variables
+ *              are skipped) and assignment to fill with their values
+ * Returns:     probability of the assignment given the evidence, or -1 if
+ *              the evidence is impossible
+ */
+double MaxProduct::solve(const vector<int> &evidence,
+                         const vector<bool> &maximize,
+                         vector<int> &assignment) const
+{
+    int n = model.numVars();
+    vector<bool> target(n), needed(n, !prune);
+    for (int v = 0; v < n; v++) {
+        target[v] = maximize[v] and evidence[v] == NONE;
+    }
+    if (prune) { // what is neither asked about nor above it sums out to 1
+        for (int i = n - 1; i >= 0; i--) {
+            int v = model.getOrder()[i];
+            needed[v] = needed[v] or target[v] or evidence[v] != NONE;
+            if (!needed[v]) {continue;}
+            for (int k = 0; k < model.getNumParents(v); k++) {
+                needed[model.getParents(v)[k]] = true;
+            }
+        }
+    }
+    vector<bool> hidden(n);
+    for (int v = 0; v < n; v++) {
+        hidden[v] = needed[v] and evidence[v] == NONE;
+    }
+    vector<int> order = eliminationOrder(model, hidden, hidden, heuristic,
+                                         &target);
+
+    vector<Factor> kept;
+    double bestScale, totalScale;
+    double best = eliminate(evidence, needed, order, target, &kept,
+                            bestScale);
+    double total = eliminate(evidence, needed, order, vector<bool>(n), NULL,
+                             totalScale);
+    if (total <= 0) {return -1;} // P(evidence) = 0
+
+    // each bucket's product only mentions variables maximized after it
+    assignment = evidence;
+    for (int b = (int)order.size() - 1; b >= 0 and target[order[b]]; b--) {
+        int var = order[b];
+        const Factor &f = kept[b];
+        int at = f.find(var);
+        if (at == NONE) { // nothing depends on it
+            assignment[var] = 0;
+            continue;
+        }
+        int base = 0, stride = 1, step = 1;
+        for (int i = f.numVars() - 1; i >= 0; i--) {
+            if (i == at) {
+                step = stride;
+            } else {
+                base += assignment[f.getVar(i)] * stride;
+            }
+            stride *= f.getCard(i);
+        }
+        int x = 0;
+        for (int i = 1; i < model.getNumVal(var); i++) {
+            if (f.getValue(base + i * step) > f.getValue(base + x * step)) {
+                x = i;
+            }
+        }
+        assignment[var] = x;
+    }
+    return best / total * exp(bestScale - totalScale);
+}
+/*
+ * eliminate()
+ * Purpose:     eliminates every variable in order, summing or maximizing
+ *              each out of the product of its bucket
+ * Parameters:  evidence, variables whose CPTs take part, elimination order
+ *              (every needed variable that is not evidence), which
+ *              variables to maximize, a vector to keep each maximized
+ *              variable's bucket product in, by position, or NULL, and
+ *              the log of the scale to set
+ * Returns:     the result, divided by the scale
+ */
+double MaxProduct::eliminate(const vector<int> &evidence,
+                             const vector<bool> &needed,
+                             const vector<int> &order,
+                             const vector<bool> &maximize,
+                             vector<Factor> *kept, double &logScale) const
+{
+    int n = model.numVars();
+    vector<int> position(n, order.size()); // evidence goes last
+    for (size_t i = 0; i < order.size(); i++) {
+        position[order[i]] = i;
+    }
+    vector<vector<Factor>> buckets(order.size() + 1);
+    for (int v = 0; v < n; v++) {
+        if (!needed[v]) {continue;}
+        Factor f = Factor(model, v).reduce(evidence);
+        int first = order.size();
+        for (int i = 0; i < f.numVars(); i++) {
+            first = min(first, position[f.getVar(i)]);
+        }
+        buckets[first].push_back(f);
+    }
+    if (kept != NULL) {kept->assign(order.size(), Factor());}
+    logScale = 0;
+    for (size_t b = 0; b < order.size(); b++) {
+        if (buckets[b].empty()) {continue;}
+        Factor f = buckets[b][0];
+        for (size_t i = 1; i < buckets[b].size(); i++) {
+            f = f.product(buckets[b][i]);
+        }
+        buckets[b].clear();
+        int var = order[b];
+        if (maximize[var]) {
+            if (kept != NULL) {(*kept)[b] = f;}
+            f = f.maxOut(var);
+        } else {
+            f = f.sumOut(var);
+        }
+        logScale += f.rescale();
+        int first = order.size();
+        for (int i = 0; i < f.numVars(); i++) {
+            first = min(first, position[f.getVar(i)]);
+        }
+        buckets[first].push_back(f);
+    }
+    double result = 1; // every variable is gone, so these are numbers
+    vector<Factor> &last = buckets[order.size()];
+    for (size_t i = 0; i < last.size(); i++) {
+        result *= last[i].getValue(0);
+    }
+    return result;
+}
@@ -0,0 +1,37 @@
+/*
+ * MaxProduct.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Most probable explanation (MPE) and partial MAP queries by
+ *          bucket elimination. The variables asked about are maximized out
+ *          after every other variable is summed out, keeping the product
+ *          each of their buckets formed; walking the buckets back in
+ *          reverse order then reads off the maximizing value of each. Each
+ *          message is rescaled to a largest entry of 1, with the scale kept
+ *          as a logarithm, so long products do not underflow.
+ */
+#ifndef _MAXPRODUCT_H_
+#define _MAXPRODUCT_H_
+
+#include "Factor.h"
+#include "Ordering.h"
+
+using namespace std;
+
+class MaxProduct {
+public:
+    MaxProduct(const Model &m, Heuristic h, bool prune);
+
+    double solve(const vector<int> &evidence, const vector<bool> &maximize,
+                 vector<int> &assignment) const;
+
+private:
+    const Model &model;
+    Heuristic heuristic;
+    bool prune; // drop variables that are neither asked about nor above
+
+    double eliminate(const vector<int> &evidence, const vector<bool> &needed,
+                     const vector<int> &order, const vector<bool> &maximize,
+                     vector<Factor> *kept, double &logScale) const;
+};
+#endif
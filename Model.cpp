@@ -0,0 +1,673 @@
+/*
+ * Model.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Model class.
+ */
+
+#include "Model.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char MAGIC[4] = {'B', 'N', 'B', 0};
+static const uint32_t VERSION = 1;
+static const int NUM_SECTIONS = 14;
+
+/*
+ * default constructor: an empty model
+ */
+Model::Model()
+{
+    mapping = NULL;
+    mappedLength = 0;
+    header = NULL;
+    numForced = numZeros = 0;
+}
+/*
+ * destructor
+ */
+Model::~Model()
+{
+    release();
+}
+/*
+ * release()
+ * Purpose:     frees the buffer of the current model
+ * Parameters:  none
+ * Returns:     none
+ */
+void Model::release()
+{
+    if (mapping != NULL) {
+        munmap(mapping, mappedLength);
+        mapping = NULL;
+        mappedLength = 0;
+    }
+    vector<uint64_t>().swap(owned); // clear() would keep the memory
+    vector<int64_t>().swap(rowStart);
+    vector<int32_t>().swap(forced);
+    determined.clear();
+    numForced = numZeros = 0;
+    header = NULL;
+}
+/*
+ * build()
+ * Purpose:     derives strides, children, the topological order and the
+ *              name hash table from a network's structure and packs them
+ *              all into one buffer of exactly the right size, with every
+ *              CPT entry 0 until fillCPT() writes it
+ * Parameters:  names, cardinalities and parents of every variable
+ * Returns:     none
+ */
+void Model::build(const Tables &t)
+{
+    release();
+    int n = t.card.size();
+    vector<int32_t> vValueStart(1, 0), vStrides(t.parents.size()),
+                    vChildStart(n + 1, 0), vChildren(t.parents.size()), vOrder;
+    vector<int64_t> vCptStart(1, 0), vNameStart(1, 0), vValueNameStart;
+    const vector<int32_t> &vCard = t.card, &vParentStart = t.parentStart,
+                          &vParents = t.parents;
+    for (int v = 0; v < n; v++) {
+        vValueStart.push_back(vValueStart.back() + vCard[v]);
+        vNameStart.push_back(t.nameEnd[v]);
+        int stride = 1;
+        for (int i = vParentStart[v + 1] - 1; i >= vParentStart[v]; i--) {
+            vStrides[i] = stride; // last parent varies fastest
+            stride *= vCard[vParents[i]];
+            vChildStart[vParents[i] + 1]++;
+        }
+        vCptStart.push_back(vCptStart.back() + (int64_t)stride * vCard[v]);
+    }
+    for (int v = 0; v < n; v++) { // children in increasing ID order
+        vChildStart[v + 1] += vChildStart[v];
+    }
+    vector<int32_t> fill(vChildStart.begin(), vChildStart.end() - 1);
+    for (int v = 0; v < n; v++) {
+        for (int i = vParentStart[v]; i < vParentStart[v + 1]; i++) {
+            vChildren[fill[vParents[i]]++] = v;
+        }
+    }
+    // names are stored variable names first, then value names
+    vValueNameStart.push_back(t.names.size());
+    for (size_t k = 0; k < t.valueEnd.size(); k++) {
+        vValueNameStart.push_back(t.names.size() + t.valueEnd[k]);
+    }
+
+    // topological order, keeping the file order where possible
+    vector<int> waiting(n);
+    vector<int> ready;
+    for (int v = n - 1; v >= 0; v--) {
+        waiting[v] = vParentStart[v + 1] - vParentStart[v];
+        if (waiting[v] == 0) {ready.push_back(v);}
+    }
+    while (!ready.empty()) {
+        int v = ready.back();
+        ready.pop_back();
+        vOrder.push_back(v);
+        for (int i = vChildStart[v + 1] - 1; i >= vChildStart[v]; i--) {
+            if (--waiting[vChildren[i]] == 0) {ready.push_back(vChildren[i]);}
+        }
+    }
+    if ((int)vOrder.size() != n) {
+        cerr << "Error: the network contains a cycle\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // name hash table: a power of two at least twice the number of names
+    uint64_t numSlots = 1;
+    while (numSlots < 2 * (uint64_t)n) {numSlots *= 2;}
+    vector<int32_t> vSlots(numSlots, NONE);
+    for (int v = 0; v < n; v++) {
+        uint64_t s = hashName(t.names.data() + vNameStart[v],
+                              vNameStart[v + 1] - vNameStart[v]) &
+                     (numSlots - 1);
+        while (vSlots[s] != NONE) {s = (s + 1) & (numSlots - 1);}
+        vSlots[s] = v;
+    }
+
+    // pack everything into one buffer in file layout
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.numVars = n;
+    h.numValues = vValueStart.back();
+    h.numParents = vParents.size();
+    h.numChildren = vChildren.size();
+    h.numSlots = numSlots;
+    h.numCPT = vCptStart.back();
+    h.numChars = t.names.size() + t.values.size();
+    size_t off[NUM_SECTIONS];
+    size_t total = layout(h, off);
+    owned.assign((total + 7) / 8, 0);
+    char *buffer = reinterpret_cast<char *>(owned.data());
+    const void *from[NUM_SECTIONS] = {
+        vCard.data(), vValueStart.data(), vParentStart.data(), vParents.data(),
+        vStrides.data(), vChildStart.data(), vChildren.data(), vOrder.data(),
+        vSlots.data(), vCptStart.data(), vNameStart.data(),
+        vValueNameStart.data(), NULL, t.names.data()
+    };
+    memcpy(buffer, &h, sizeof(h));
+    for (int i = 0; i < NUM_SECTIONS; i++) {
+        size_t end = (i + 1 < NUM_SECTIONS) ? off[i + 1] : total;
+        size_t bytes = 0;
+        switch (i) { // exact size; the rest of the section is padding
+            case 0: case 7: bytes = n * 4; break;
+            case 1: case 2: case 5: bytes = (n + 1) * 4; break;
+            case 3: case 4: bytes = h.numParents * 4; break;
+            case 6: bytes = h.numChildren * 4; break;
+            case 8: bytes = numSlots * 4; break;
+            case 9: case 10: bytes = (n + 1) * 8; break;
+            case 11: bytes = (h.numValues + 1) * 8; break;
+            case 13: bytes = t.names.size(); break;
+        }
+        if (bytes > 0 and bytes <= end - off[i]) {
+            memcpy(buffer + off[i], from[i], bytes);
+        }
+    }
+    memcpy(buffer + off[13] + t.names.size(), t.values.data(), t.values.size());
+    attach(buffer, total);
+}
+/*
+ * fillCPT()
+ * Purpose:     gives the CPT section of a model just built, so the parser
+ *              can write each row straight to its place
+ * Parameters:  none
+ * Returns:     the first entry; the CPT of v starts at getCPT(v)
+ */
+double *Model::fillCPT()
+{
+    return const_cast<double *>(cpt); // build() owns the buffer
+}
+/*
+ * analyze()
+ * Purpose:     records the determinism in the CPTs: which rows give one
+ *              value probability 1 (so inference can fix it instead of
+ *              branching), which variables are deterministic functions of
+ *              their parents, and how many entries are 0
+ * Parameters:  none; call once the CPTs are filled
+ * Returns:     none
+ */
+void Model::analyze()
+{
+    int n = numVars();
+    rowStart.assign(n + 1, 0);
+    for (int v = 0; v < n; v++) {
+        rowStart[v + 1] = rowStart[v] +
+                          (cptStart[v + 1] - cptStart[v]) / card[v];
+    }
+    forced.assign(rowStart[n], NONE);
+    determined.assign(n, true);
+    numForced = numZeros = 0;
+    for (int v = 0; v < n; v++) {
+        const double *entry = getCPT(v);
+        for (int64_t r = rowStart[v]; r < rowStart[v + 1]; r++) {
+            for (int x = 0; x < card[v]; x++, entry++) {
+                if (*entry == 0) {numZeros++;}
+                if (*entry == 1) {forced[r] = x;}
+            }
+            if (forced[r] == NONE) {
+                determined[v] = false;
+            } else {
+                numForced++;
+            }
+        }
+    }
+}
+/*
+ * footprint()
+ * Purpose:     prints the memory the model takes, by part
+ * Parameters:  stream
+ * Returns:     none
+ */
+void Model::footprint(ostream &out) const
+{
+    if (header == NULL) {
+        out << "Model: none loaded\n";
+        return;
+    }
+    size_t off[NUM_SECTIONS + 1];
+    off[NUM_SECTIONS] = layout(*header, off);
+    // sections of each part; see layout()
+    static const char *PARTS[] = {"structure", "names", "CPTs"};
+    static const int PART_OF[NUM_SECTIONS] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1,
+                                              1, 2, 1};
+    size_t bytes[3] = {off[0], 0, 0}; // the header counts as structure
+    for (int i = 0; i < NUM_SECTIONS; i++) {
+        bytes[PART_OF[i]] += off[i + 1] - off[i];
+    }
+    out << "Model: " << header->numVars << " variables, "
+        << header->numValues << " values, " << header->numParents
+        << " parent links, " << header->numCPT << " CPT entries\n";
+    for (int p = 0; p < 3; p++) {
+        out << "  " << left << setw(10) << PARTS[p] << right << setw(10)
+            << showSize(bytes[p]) << "\n";
+    }
+    out << "  " << left << setw(10) << "total" << right << setw(10)
+        << showSize(off[NUM_SECTIONS]) << ", "
+        << (mapping != NULL ? "mapped from the file" : "in one buffer")
+        << "\n";
+    int deterministic = count(determined.begin(), determined.end(), true);
+    out << "Determinism: " << deterministic << " deterministic variables, "
+        << numForced << " of " << rowStart.back() << " CPT rows force a "
+        << "value, " << numZeros << " zero entries\n";
+}
+/*
+ * showSize()
+ * Purpose:     formats a number of bytes in KB or MB
+ * Parameters:  bytes
+ * Returns:     e.g. "1.5 MB"
+ */
+string Model::showSize(uint64_t bytes)
+{
+    char buf[32];
+    if (bytes < 1048576) {
+        snprintf(buf, sizeof(buf), "%.1f KB", bytes / 1024.0);
+    } else {
+        snprintf(buf, sizeof(buf), "%.1f MB", bytes / 1048576.0);
+    }
+    return buf;
+}
+/*
+ * layout()
+ * Purpose:     finds where each section of a model buffer starts
+ * Parameters:  header and array to fill with NUM_SECTIONS offsets
+ * Returns:     total length of the buffer
+ */
+size_t Model::layout(const Header &h, size_t offsets[])
+{
+    uint64_t n = h.numVars;
+    uint64_t sizes[NUM_SECTIONS] = {
+        n * 4,                 // card
+        (n + 1) * 4,           // valueStart
+        (n + 1) * 4,           // parentStart
+        h.numParents * 4,      // parents
+        h.numParents * 4,      // strides
+        (n + 1) * 4,           // childStart
+        h.numChildren * 4,     // children
+        n * 4,                 // order
+        h.numSlots * 4,        // slots
+        (n + 1) * 8,           // cptStart
+        (n + 1) * 8,           // nameStart
+        (h.numValues + 1) * 8, // valueNameStart
+        h.numCPT * 8,          // cpt
+        h.numChars             // chars
+    };
+    size_t pos = (sizeof(Header) + 7) & ~(size_t)7;
+    for (int i = 0; i < NUM_SECTIONS; i++) { // every section 8-byte aligned
+        offsets[i] = pos;
+        pos = (pos + sizes[i] + 7) & ~(size_t)7;
+    }
+    return pos;
+}
+/*
+ * attach()
+ * Purpose:     checks a model buffer and points the arrays into it
+ * Parameters:  buffer and its length
+ * Returns:     true if the buffer holds a model of this version whose
+ *              every index stays inside the buffer
+ */
+bool Model::attach(const char *buffer, size_t length)
+{
+    if (length < sizeof(Header)) {return false;}
+    const Header *h = reinterpret_cast<const Header *>(buffer);
+    if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 or h->version != VERSION) {
+        return false;
+    }
+    const uint64_t counts[] = {h->numVars, h->numValues, h->numParents,
+                               h->numChildren, h->numSlots, h->numCPT,
+                               h->numChars};
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        if (counts[i] > length) {return false;} // layout() would overflow
+    }
+    size_t off[NUM_SECTIONS];
+    if (layout(*h, off) != length) {return false;}
+    header = h;
+    card = reinterpret_cast<const int32_t *>(buffer + off[0]);
+    valueStart = reinterpret_cast<const int32_t *>(buffer + off[1]);
+    parentStart = reinterpret_cast<const int32_t *>(buffer + off[2]);
+    parents = reinterpret_cast<const int32_t *>(buffer + off[3]);
+    strides = reinterpret_cast<const int32_t *>(buffer + off[4]);
+    childStart = reinterpret_cast<const int32_t *>(buffer + off[5]);
+    children = reinterpret_cast<const int32_t *>(buffer + off[6]);
+    order = reinterpret_cast<const int32_t *>(buffer + off[7]);
+    slots = reinterpret_cast<const int32_t *>(buffer + off[8]);
+    cptStart = reinterpret_cast<const int64_t *>(buffer + off[9]);
+    nameStart = reinterpret_cast<const int64_t *>(buffer + off[10]);
+    valueNameStart = reinterpret_cast<const int64_t *>(buffer + off[11]);
+    cpt = reinterpret_cast<const double *>(buffer + off[12]);
+    chars = buffer + off[13];
+    if (!inBounds()) {
+        header = NULL;
+        return false;
+    }
+    return true;
+}
+/*
+ * inBounds()
+ * Purpose:     checks every array of a model buffer that indexes another,
+ *              so a corrupt file cannot make inference read outside the
+ *              buffer: counts and starts add up, IDs are in range, the
+ *              strides match the cardinalities, the order is topological
+ *              and the name table has a free slot to stop lookups
+ * Parameters:  none; the arrays point into the buffer
+ * Returns:     true if the buffer is consistent
+ */
+bool Model::inBounds() const
+{
+    int64_t n = header->numVars;
+    if (n >= INT32_MAX or header->numChildren != header->numParents or
+        header->numSlots <= (uint64_t)n or
+        (header->numSlots & (header->numSlots - 1)) != 0) {
+        return false;
+    }
+    if (valueStart[0] != 0 or parentStart[0] != 0 or childStart[0] != 0 or
+        cptStart[0] != 0 or nameStart[0] != 0) {
+        return false;
+    }
+    for (int64_t v = 0; v < n; v++) {
+        if (card[v] < 1 or valueStart[v + 1] != valueStart[v] + card[v] or
+            parentStart[v + 1] < parentStart[v] or
+            childStart[v + 1] < childStart[v] or
+            nameStart[v + 1] < nameStart[v]) {
+            return false;
+        }
+    }
+    if ((uint64_t)valueStart[n] != header->numValues or
+        (uint64_t)parentStart[n] != header->numParents or
+        (uint64_t)childStart[n] != header->numChildren or
+        (uint64_t)cptStart[n] != header->numCPT or
+        valueNameStart[0] != nameStart[n]) {
+        return false;
+    }
+    for (uint64_t i = 0; i < header->numParents; i++) {
+        if (parents[i] < 0 or parents[i] >= n or children[i] < 0 or
+            children[i] >= n) {
+            return false;
+        }
+    }
+    for (int64_t v = 0; v < n; v++) {
+        int64_t stride = 1; // last parent varies fastest
+        for (int i = parentStart[v + 1] - 1; i >= parentStart[v]; i--) {
+            if (strides[i] != stride) {return false;}
+            stride *= card[parents[i]];
+            if (stride > (int64_t)header->numCPT) {return false;}
+        }
+        if (cptStart[v + 1] - cptStart[v] != stride * card[v]) {return false;}
+    }
+    for (uint64_t k = 0; k < header->numValues; k++) {
+        if (valueNameStart[k + 1] < valueNameStart[k]) {return false;}
+    }
+    if ((uint64_t)valueNameStart[header->numValues] > header->numChars) {
+        return false;
+    }
+    vector<int> position(n, NONE);
+    for (int64_t i = 0; i < n; i++) {
+        if (order[i] < 0 or order[i] >= n or position[order[i]] != NONE) {
+            return false;
+        }
+        position[order[i]] = i;
+    }
+    for (int64_t v = 0; v < n; v++) {
+        for (int i = parentStart[v]; i < parentStart[v + 1]; i++) {
+            if (position[parents[i]] >= position[v]) {return false;}
+        }
+    }
+    bool free = false;
+    for (uint64_t s = 0; s < header->numSlots; s++) {
+        if (slots[s] < NONE or slots[s] >= n) {return false;}
+        free = free or slots[s] == NONE;
+    }
+    return free;
+}
+/*
+ * save()
+ * Purpose:     writes the model buffer to a compiled model file
+ * Parameters:  filename
+ * Returns:     none; exits with an error if it could not be written
+ */
+void Model::save(const string &filename) const
+{
+    ofstream outfile(filename, ios::binary);
+    if (!outfile.is_open()) {
+        cerr << "Error: could not open " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    size_t off[NUM_SECTIONS];
+    outfile.write(reinterpret_cast<const char *>(header), layout(*header, off));
+    outfile.close();
+    if (!outfile) { // a truncated model fails attach()'s checks
+        cerr << "Error: could not write " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+}
+/*
+ * load()
+ * Purpose:     maps a compiled model file into memory and uses it in place
+ * Parameters:  filename
+ * Returns:     none
+ */
+void Model::load(const string &filename)
+{
+    release();
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 or fstat(fd, &info) != 0) {
+        cerr << "Error: could not open " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    mappedLength = info.st_size;
+    mapping = mmap(NULL, mappedLength, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping stays valid
+    if (mapping == MAP_FAILED or
+        !attach(static_cast<const char *>(mapping), mappedLength)) {
+        if (mapping == MAP_FAILED) {mapping = NULL;}
+        release();
+        cerr << "Error: " << filename << " is not a valid compiled model "
+             << "of version " << VERSION << "\n";
+        exit(EXIT_FAILURE);
+    }
+    analyze();
+}
+/*
+ * isCompiled()
+ * Purpose:     determines if a file is a compiled model
+ * Parameters:  filename
+ * Returns:     true if it starts with the compiled model magic
+ */
+bool Model::isCompiled(const string &filename)
+{
+    ifstream infile(filename, ios::binary);
+    char magic[sizeof(MAGIC)];
+    if (!infile.read(magic, sizeof(magic))) {return false;}
+    return memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+/*
+ * fingerprint()
+ * Purpose:     hash of the whole model buffer, so files derived from a
+ *              model can tell whether they still belong to it
+ * Parameters:  none
+ * Returns:     hash
+ */
+uint64_t Model::fingerprint() const
+{
+    size_t off[NUM_SECTIONS];
+    return hashName(reinterpret_cast<const char *>(header),
+                    layout(*header, off));
+}
+/*
+ * hashName()
+ * Purpose:     FNV-1a hash of a name, fixed so saved tables stay valid
+ * Parameters:  name and its length
+ * Returns:     hash
+ */
+uint64_t Model::hashName(const char *name, size_t length)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        h = (h ^ (unsigned char)name[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+/*
+ * sameName()
+ * Purpose:     compares a name in the buffer to a string
+ * Parameters:  start and end of the name in chars, string
+ * Returns:     true if equal
+ */
+bool Model::sameName(int64_t start, int64_t end, const string &name) const
+{
+    return (size_t)(end - start) == name.size() and
+           memcmp(chars + start, name.data(), name.size()) == 0;
+}
+/*
+ * numVars()
+ * Purpose:     get number of variables
+ * Parameters:  none
+ * Returns:     number of variables
+ */
+int Model::numVars() const
+{
+    return header == NULL ? 0 : header->numVars;
+}
+/*
+ * getVar()
+ * Purpose:     get ID of variable
+ * Parameters:  variable name
+ * Returns:     ID, or NONE if there is no such variable
+ */
+int Model::getVar(const string &name) const
+{
+    if (numVars() == 0) {return NONE;}
+    uint64_t mask = header->numSlots - 1;
+    uint64_t s = hashName(name.data(), name.size()) & mask;
+    STAT_COUNT(NAME_LOOKUPS, 1);
+    while (slots[s] != NONE) { // linear probing
+        STAT_COUNT(NAME_PROBES, 1);
+        int v = slots[s];
+        if (sameName(nameStart[v], nameStart[v + 1], name)) {return v;}
+        s = (s + 1) & mask;
+    }
+    return NONE;
+}
+/*
+ * getValue()
+ * Purpose:     get ID of one of a variable's values
+ * Parameters:  variable ID and value name
+ * Returns:     value ID, or NONE if the variable has no such value
+ */
+int Model::getValue(int var, const string &value) const
+{
+    STAT_COUNT(NAME_LOOKUPS, 1);
+    for (int i = 0; i < card[var]; i++) {
+        STAT_COUNT(NAME_PROBES, 1);
+        int k = valueStart[var] + i;
+        if (sameName(valueNameStart[k], valueNameStart[k + 1], value)) {
+            return i;
+        }
+    }
+    return NONE;
+}
+/*
+ * getName()
+ * Purpose:     get name of variable
+ * Parameters:  variable ID
+ * Returns:     name
+ */
+string Model::getName(int var) const
+{
+    return string(chars + nameStart[var], nameStart[var + 1] - nameStart[var]);
+}
+/*
+ * getValueName()
+ * Purpose:     get name of one of a variable's values
+ * Parameters:  variable ID and value ID
+ * Returns:     value name
+ */
+string Model::getValueName(int var, int value) const
+{
+    int k = valueStart[var] + value;
+    return string(chars + valueNameStart[k],
+                  valueNameStart[k + 1] - valueNameStart[k]);
+}
+/*
+ * getNumVal()
+ * Purpose:     get number of possible values
+ * Parameters:  variable ID
+ * Returns:     number of possible values
+ */
+int Model::getNumVal(int var) const
+{
+    return card[var];
+}
+/*
+ * getNumParents()
+ * Purpose:     get total number of parents
+ * Parameters:  variable ID
+ * Returns:     number of parents
+ */
+int Model::getNumParents(int var) const
+{
+    return parentStart[var + 1] - parentStart[var];
+}
+/*
+ * getParents()
+ * Purpose:     get IDs of parents, in CPT key order
+ * Parameters:  variable ID
+ * Returns:     pointer to first parent
+ */
+const int *Model::getParents(int var) const
+{
+    return parents + parentStart[var];
+}
+/*
+ * getStrides()
+ * Purpose:     get the stride of each parent between rows of the CPT
+ * Parameters:  variable ID
+ * Returns:     pointer to the first parent's stride
+ */
+const int *Model::getStrides(int var) const
+{
+    return strides + parentStart[var];
+}
+/*
+ * getNumChildren()
+ * Purpose:     get total number of children
+ * Parameters:  variable ID
+ * Returns:     number of children
+ */
+int Model::getNumChildren(int var) const
+{
+    return childStart[var + 1] - childStart[var];
+}
+/*
+ * getChildren()
+ * Purpose:     get IDs of children
+ * Parameters:  variable ID
+ * Returns:     pointer to first child
+ */
+const int *Model::getChildren(int var) const
+{
+    return children + childStart[var];
+}
+/*
+ * getOrder()
+ * Purpose:     get variables in topological order
+ * Parameters:  none
+ * Returns:     pointer to numVars() variable IDs
+ */
+const int *Model::getOrder() const
+{
+    return order;
+}
@@ -0,0 +1,168 @@
+/*
+ * Model.h
+ * by: Valerie Zhang
+ *
+ * Purpose: The Model class is a compiled, integer-indexed Bayes Network.
+ *          Every variable and value is given a dense integer ID and every
+ *          CPT is stored as one flat array of doubles indexed by
+ *          mixed-radix parent strides, so inference can run without any
+ *          string hashing or allocation.
+ *
+ *          All arrays live in one buffer laid out exactly like a compiled
+ *          (.bnb) model file, so a saved model can be mmapped and used in
+ *          place, with no parsing, and its pages shared between processes.
+ *          A loaded file is range-checked once before use, so a corrupt
+ *          or foreign .bnb file is rejected rather than read out of bounds.
+ *          A parsed model is the same buffer, allocated once at its exact
+ *          size: there is no object per variable, value or CPT row, so
+ *          memory grows linearly with the network.
+ */
+
+#ifndef _MODEL_H_
+#define _MODEL_H_
+
+#include "Stats.h"
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const int NONE = -1; // value ID of an unassigned variable
+
+class Model {
+public:
+    /* the structure of a network a model is built from, in variable order;
+       the CPTs are filled in afterwards, in place */
+    struct Tables {
+        string names;              // variable names, back to back
+        vector<int64_t> nameEnd;   // end of each variable's name
+        string values;             // value names, back to back
+        vector<int64_t> valueEnd;  // end of each value's name
+        vector<int32_t> card;      // number of values of each variable
+        vector<int32_t> parentStart; // parents of v are parentStart[v]..[v + 1]
+        vector<int32_t> parents;   // in CPT key order
+    };
+
+    Model();
+    ~Model();
+
+    void build(const Tables &t);
+    double *fillCPT();
+    void analyze();
+    void save(const string &filename) const;
+    void load(const string &filename);
+    static bool isCompiled(const string &filename);
+    uint64_t fingerprint() const;
+    static uint64_t hashName(const char *name, size_t length);
+
+    int numVars() const;
+    int getVar(const string &name) const;
+    int getValue(int var, const string &value) const;
+    string getName(int var) const;
+    string getValueName(int var, int value) const;
+    int getNumVal(int var) const;
+    int getNumParents(int var) const;
+    const int *getParents(int var) const;
+    const int *getStrides(int var) const;
+    int getNumChildren(int var) const;
+    const int *getChildren(int var) const;
+    const int *getOrder() const;
+
+    /*
+     * getRow()
+     * Purpose:     index of the CPT row selected by the parents' values
+     * Parameters:  variable and full assignment (parents must be assigned)
+     * Returns:     row index
+     *
+     * Kept in the header so the inference loops can inline it.
+     */
+    int getRow(int var, const int *assignment) const
+    {
+        int row = 0;
+        for (int i = parentStart[var]; i < parentStart[var + 1]; i++) {
+            row += assignment[parents[i]] * strides[i];
+        }
+        return row;
+    }
+    /*
+     * getProbability()
+     * Purpose:     P(var = assignment[var] | parents' assigned values)
+     * Parameters:  variable and full assignment
+     * Returns:     conditional probability
+     */
+    double getProbability(int var, const int *assignment) const
+    {
+        STAT_COUNT(CPT_LOOKUPS, 1);
+        return cpt[cptStart[var] + getRow(var, assignment) * card[var] +
+                   assignment[var]];
+    }
+    const double *getCPT(int var) const { return &cpt[cptStart[var]]; }
+    /*
+     * getForced()
+     * Purpose:     the value a variable must take given its parents, when
+     *              their values give it a CPT row with a 1 in it
+     * Parameters:  variable and full assignment (parents must be assigned)
+     * Returns:     value ID, or NONE if the row leaves a choice
+     */
+    int getForced(int var, const int *assignment) const
+    {
+        return forced[rowStart[var] + getRow(var, assignment)];
+    }
+    bool isDeterministic(int var) const { return determined[var]; }
+
+    void footprint(ostream &out) const;
+    static string showSize(uint64_t bytes);
+
+private:
+    /* start of a model buffer; the sections follow in the order below */
+    struct Header {
+        char magic[4];        // "BNB" and a 0
+        uint32_t version;
+        uint64_t numVars;
+        uint64_t numValues;   // values of all variables
+        uint64_t numParents;  // parent links
+        uint64_t numChildren; // child links (same as numParents)
+        uint64_t numSlots;    // name hash table slots
+        uint64_t numCPT;      // CPT entries
+        uint64_t numChars;    // bytes of names
+    };
+
+    Model(const Model &other);            // arrays point into the buffer,
+    Model &operator=(const Model &other); // so models are not copied
+
+    vector<uint64_t> owned;   // buffer of a compiled model (8-byte aligned)
+    void *mapping;            // buffer of a loaded model, NULL if none
+    size_t mappedLength;
+
+    const Header *header;
+    const int32_t *card;      // number of values of each variable
+    const int32_t *valueStart;
+    const int32_t *parentStart; // parents of v are parentStart[v]..[v + 1]
+    const int32_t *parents;
+    const int32_t *strides;   // stride of each parent in v's CPT rows
+    const int32_t *childStart;
+    const int32_t *children;
+    const int32_t *order;     // topological order of the variables
+    const int32_t *slots;     // open-addressed hash table of variable IDs
+    const int64_t *cptStart;  // CPT of v starts at cptStart[v]
+    const int64_t *nameStart; // name of v is chars[nameStart[v]..[v + 1]]
+    const int64_t *valueNameStart;
+    const double *cpt;
+    const char *chars;
+
+    // found by analyze() once the CPTs are known; not part of the file
+    vector<int64_t> rowStart; // rows of v start at rowStart[v]
+    vector<int32_t> forced;   // per row, its value of probability 1 or NONE
+    vector<bool> determined;  // every row of v forces a value
+    int64_t numForced;        // rows that force a value
+    int64_t numZeros;         // CPT entries of probability 0
+
+    void release();
+    bool attach(const char *buffer, size_t length);
+    bool inBounds() const;
+    static size_t layout(const Header &h, size_t offsets[]);
+    bool sameName(int64_t start, int64_t end, const string &name) const;
+};
+#endif
@@ -0,0 +1,80 @@
+/*
+ * NetGen.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: Writes a synthetic network to stdout, for testing and
+ *          benchmarking:
+ *              ./netgen chain|polytree|dag vars [options] > net.txt
+ *              ./netgen grid rowsxcols [options] > net.txt
+ *          Options:
+ *              --arity a or a-b  values per variable (default 2)
+ *              --in-degree k     most parents in a polytree, parents of
+ *                                each variable in a dag (default 2)
+ *              --window w        dag parents come from the w variables
+ *                                before each one, 0 for any (default 0)
+ *              --seed n          same seed, same network (default 1)
+ */
+#include "Generator.h"
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+static void usage() {
+    cerr << "Usage: ./netgen chain|polytree|dag vars [--arity a[-b]] "
+         << "[--in-degree k]\n"
+         << "                [--window w] [--seed n]\n"
+         << "       ./netgen grid rowsxcols [--arity a[-b]] [--seed n]\n";
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        usage();
+    }
+    string shape = argv[1];
+    string size = argv[2];
+    int minArity = 2, maxArity = 2, inDegree = 2, window = 0;
+    uint64_t seed = 1;
+    for (int a = 3; a < argc; a++) {
+        string flag = argv[a];
+        if (a + 1 == argc) {usage();}
+        string arg = argv[++a];
+        if (flag == "--arity") {
+            if (sscanf(arg.c_str(), "%d-%d", &minArity, &maxArity) == 1) {
+                maxArity = minArity;
+            }
+        } else if (flag == "--in-degree") {
+            inDegree = atoi(arg.c_str());
+        } else if (flag == "--window") {
+            window = atoi(arg.c_str());
+        } else if (flag == "--seed") {
+            seed = strtoull(arg.c_str(), NULL, 10);
+        } else {
+            usage();
+        }
+    }
+    if (minArity < 2 or maxArity < minArity or inDegree < 0 or window < 0) {
+        usage();
+    }
+    Generator g(minArity, maxArity, seed);
+    int n = atoi(size.c_str()), rows = 0, cols = 0;
+    if (shape == "grid" and
+        sscanf(size.c_str(), "%dx%d", &rows, &cols) == 2 and
+        rows > 0 and cols > 0) {
+        g.grid(rows, cols);
+    } else if (n <= 0) {
+        usage();
+    } else if (shape == "chain") {
+        g.chain(n);
+    } else if (shape == "polytree") {
+        g.polytree(n, inDegree);
+    } else if (shape == "dag") {
+        g.dag(n, inDegree, window);
+    } else {
+        usage();
+    }
+    g.write(cout);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Ordering.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of the min-fill and min-degree elimination
+ *          ordering heuristics.
+ */
+#include "Ordering.h"
+#include <set>
+
+using namespace std;
+
+/*
+ * score()
+ * Purpose:     cost of eliminating a variable next
+ * Parameters:  graph, variable and heuristic
+ * Returns:     number of fill-in edges, or number of neighbors
+ */
+static int score(const vector<set<int>> &adj, int var, Heuristic h)
+{
+    if (h == MIN_DEGREE) {return adj[var].size();}
+    int fill = 0;
+    set<int>::const_iterator a, b;
+    for (a = adj[var].begin(); a != adj[var].end(); ++a) {
+        for (b = a, ++b; b != adj[var].end(); ++b) {
+            if (adj[*a].count(*b) == 0) {fill++;}
+        }
+    }
+    return fill;
+}
+/*
+ * moralGraph()
+ * Purpose:     builds the moral graph over the variables in the graph
+ * Parameters:  model, which variables are in the graph and adjacency
+ *              sets to fill
+ * Returns:     none
+ */
+static void moralGraph(const Model &m, const vector<bool> &inGraph,
+                       vector<set<int>> &adj)
+{
+    int n = m.numVars();
+    adj.assign(n, set<int>());
+    for (int v = 0; v < n; v++) { // connect each family
+        if (!inGraph[v]) {continue;}
+        vector<int> family(m.getParents(v), m.getParents(v) + m.getNumParents(v));
+        family.push_back(v);
+        for (size_t i = 0; i < family.size(); i++) {
+            for (size_t j = i + 1; j < family.size(); j++) {
+                int a = family[i], b = family[j];
+                if (inGraph[a] and inGraph[b]) {
+                    adj[a].insert(b);
+                    adj[b].insert(a);
+                }
+            }
+        }
+    }
+}
+/*
+ * removeVar()
+ * Purpose:     removes a variable from the graph, connecting its neighbors
+ * Parameters:  graph and variable
+ * Returns:     the variable's neighbors before it was removed
+ */
+static vector<int> removeVar(vector<set<int>> &adj, int v)
+{
+    vector<int> nbrs(adj[v].begin(), adj[v].end());
+    for (size_t i = 0; i < nbrs.size(); i++) {
+        adj[nbrs[i]].erase(v);
+        for (size_t j = i + 1; j < nbrs.size(); j++) {
+            adj[nbrs[i]].insert(nbrs[j]);
+            adj[nbrs[j]].insert(nbrs[i]);
+        }
+    }
+    adj[v].clear();
+    return nbrs;
+}
+/*
+ * parseHeuristic()
+ * Purpose:     gets heuristic from its command line name
+ * Parameters:  name ("minfill" or "mindegree") and heuristic to set
+ * Returns:     true if the name is known, false if not
+ */
+bool parseHeuristic(const string &name, Heuristic &h)
+{
+    if (name == "minfill") {
+        h = MIN_FILL;
+    } else if (name == "mindegree") {
+        h = MIN_DEGREE;
+    } else {
+        return false;
+    }
+    return true;
+}
+/*
+ * eliminationOrder()
+ * Purpose:     greedily orders variables for elimination on the moral graph
+ *              of the variables in the graph
+ * Parameters:  model, which variables are in the graph, which of them to
+ *              eliminate, the heuristic, and optionally which of those to
+ *              eliminate only after all the others (e.g. maximized after
+ *              summed)
+ * Returns:     variables to eliminate, in order
+ */
+vector<int> eliminationOrder(const Model &m, const vector<bool> &inGraph,
+                             const vector<bool> &eliminate, Heuristic h,
+                             const vector<bool> *last)
+{
+    int n = m.numVars();
+    vector<set<int>> adj;
+    moralGraph(m, inGraph, adj);
+    set<pair<int, int>> queue; // (score, variable), cheapest first
+    vector<int> scores(n, 0);
+    for (int v = 0; v < n; v++) {
+        if (inGraph[v] and eliminate[v]) {
+            scores[v] = score(adj, v, h);
+            queue.insert(make_pair(scores[v], v));
+        }
+    }
+    set<pair<int, int>> later; // the last variables, once queue runs dry
+    if (last != NULL) {
+        for (set<pair<int, int>>::iterator it = queue.begin();
+             it != queue.end();) {
+            if ((*last)[it->second]) {
+                later.insert(*it);
+                queue.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+    vector<int> order;
+    while (!queue.empty() or !later.empty()) {
+        if (queue.empty()) {queue.swap(later);}
+        int v = queue.begin()->second;
+        queue.erase(queue.begin());
+        order.push_back(v);
+        vector<int> nbrs = removeVar(adj, v);
+        set<int> changed(nbrs.begin(), nbrs.end());
+        if (h == MIN_FILL) { // fill-in also changes one step further out
+            for (size_t i = 0; i < nbrs.size(); i++) {
+                changed.insert(adj[nbrs[i]].begin(), adj[nbrs[i]].end());
+            }
+        }
+        for (set<int>::iterator it = changed.begin(); it != changed.end(); ++it) {
+            int u = *it;
+            set<pair<int, int>> &q = later.count(make_pair(scores[u], u))
+                                     ? later : queue;
+            if (!eliminate[u] or !q.count(make_pair(scores[u], u))) {
+                continue;
+            }
+            q.erase(make_pair(scores[u], u));
+            scores[u] = score(adj, u, h);
+            q.insert(make_pair(scores[u], u));
+        }
+    }
+    return order;
+}
+/*
+ * eliminationCliques()
+ * Purpose:     eliminates every variable in order from the moral graph of
+ *              the whole model
+ * Parameters:  model and elimination order covering every variable
+ * Returns:     for each position in the order, the eliminated variable
+ *              followed by its neighbors at that time
+ */
+vector<vector<int>> eliminationCliques(const Model &m, const vector<int> &order)
+{
+    vector<set<int>> adj;
+    moralGraph(m, vector<bool>(m.numVars(), true), adj);
+    vector<vector<int>> cliques;
+    for (size_t i = 0; i < order.size(); i++) {
+        vector<int> clique = removeVar(adj, order[i]);
+        clique.insert(clique.begin(), order[i]);
+        cliques.push_back(clique);
+    }
+    return cliques;
+}
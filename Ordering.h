@@ -0,0 +1,24 @@
+/*
+ * Ordering.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Greedy elimination orderings over the moral graph of a Model,
+ *          used by the factor-based engines.
+ */
+#ifndef _ORDERING_H_
+#define _ORDERING_H_
+
+#include "Model.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum Heuristic { MIN_FILL, MIN_DEGREE };
+
+bool parseHeuristic(const string &name, Heuristic &h);
+vector<int> eliminationOrder(const Model &m, const vector<bool> &inGraph,
+                             const vector<bool> &eliminate, Heuristic h,
+                             const vector<bool> *last = NULL);
+vector<vector<int>> eliminationCliques(const Model &m, const vector<int> &order);
+#endif
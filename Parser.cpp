@@ -0,0 +1,426 @@
+/*
+ * Parser.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Parser class.
+ */
+#include "Parser.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/* powers of ten a double holds exactly */
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_DIGITS = 19; // decimal digits that fit in a uint64_t
+static const double ROW_TOLERANCE = 1e-4; // rounding a CPT row's sum may show
+
+static inline bool isDigit(char c) { return c >= '0' and c <= '9'; }
+static inline bool isSpace(char c)
+{
+    return c == ' ' or c == '\t' or c == '\r' or c == '\v' or c == '\f';
+}
+
+/*
+ * constructor
+ */
+Parser::Parser()
+{
+    mapping = NULL;
+    length = 0;
+    pos = end = lineStart = NULL;
+    lineNum = 0;
+    model = NULL;
+    cpt = NULL;
+}
+/*
+ * destructor
+ */
+Parser::~Parser()
+{
+    if (mapping != NULL) {munmap(mapping, length);}
+}
+/*
+ * parse()
+ * Purpose:     reads a network file into a model in one pass over the file
+ * Parameters:  filename and model to fill
+ * Returns:     none
+ */
+void Parser::parse(const string &file, Model &m)
+{
+    model = &m;
+    filename = file;
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 or fstat(fd, &info) != 0) {
+        cerr << "Error: could not open " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    length = info.st_size;
+    if (length > 0) {
+        mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            mapping = NULL;
+            cerr << "Error: could not read " << filename << "\n";
+            exit(EXIT_FAILURE);
+        }
+        madvise(mapping, length, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    pos = static_cast<const char *>(mapping);
+    end = pos + length;
+
+    Model::Tables t;
+    int section = 0; // variables, then parents, then CPTs
+    int var = NONE;  // variable whose CPT rows are being read
+    while (nextLine()) {
+        if (*lineStart == '#') {
+            if (++section > 2) {error(lineStart, "unexpected section");}
+            if (section == 1) {hasParents.assign(names.size(), false);}
+            if (section == 2) {finishStructure(t);}
+        } else if (tokens.empty()) {
+            continue; // blank line
+        } else if (section == 0) {
+            addVar(t);
+        } else if (section == 1) {
+            addParents();
+        } else {
+            const Token &last = tokens.back();
+            if (tokens.size() > 1 or isDigit(last.start[last.length - 1])) {
+                if (var == NONE) {
+                    error(tokens[0].start, "CPT row before any variable name");
+                }
+                addRow(var);
+            } else { // the name of the next CPT
+                var = find(tokens[0]);
+                if (var == NONE) {error(tokens[0].start, "unknown variable");}
+                if (cptLine[var] != 0) {
+                    error(tokens[0].start, "CPT given twice");
+                }
+                cptLine[var] = lineNum;
+            }
+        }
+    }
+    if (section == 0) {hasParents.assign(names.size(), false);}
+    if (section < 2) {finishStructure(t);}
+    checkCPTs();
+    model->analyze();
+}
+/*
+ * nextLine()
+ * Purpose:     splits the next line of the file into tokens
+ * Parameters:  none
+ * Returns:     false at the end of the file
+ */
+bool Parser::nextLine()
+{
+    if (pos >= end) {return false;}
+    lineStart = pos;
+    lineNum++;
+    const char *stop = static_cast<const char *>(memchr(pos, '\n', end - pos));
+    if (stop == NULL) {stop = end;}
+    pos = stop + 1;
+    tokens.clear();
+    const char *p = lineStart;
+    while (p < stop) {
+        while (p < stop and isSpace(*p)) {p++;}
+        if (p == stop) {break;}
+        Token word;
+        word.start = p;
+        while (p < stop and !isSpace(*p)) {p++;}
+        word.length = p - word.start;
+        tokens.push_back(word);
+    }
+    return true;
+}
+/*
+ * addVar()
+ * Purpose:     adds a variable and its values
+ * Parameters:  tables to fill
+ * Returns:     none
+ */
+void Parser::addVar(Model::Tables &t)
+{
+    const Token &name = tokens[0];
+    if (find(name) != NONE) {error(name.start, "variable declared twice");}
+    if (isDigit(name.start[name.length - 1])) {
+        // a CPT line ending in a digit is read as a row of numbers
+        error(name.start + name.length - 1,
+              "variable name must not end in a digit");
+    }
+    if (tokens.size() < 2) {error(name.start, "variable has no values");}
+    int v = names.size();
+    names.push_back(name);
+    t.names.append(name.start, name.length);
+    t.nameEnd.push_back(t.names.size());
+    valueStart.push_back(values.size());
+    for (size_t i = 1; i < tokens.size(); i++) {
+        values.push_back(tokens[i]);
+        t.values.append(tokens[i].start, tokens[i].length);
+        t.valueEnd.push_back(t.values.size());
+    }
+    t.card.push_back(tokens.size() - 1);
+
+    if (2 * names.size() > slots.size()) { // keep the table half empty
+        slots.assign(slots.empty() ? 64 : 2 * slots.size(), NONE);
+        for (size_t u = 0; u < names.size(); u++) {
+            uint64_t s = Model::hashName(names[u].start, names[u].length);
+            s &= slots.size() - 1;
+            while (slots[s] != NONE) {s = (s + 1) & (slots.size() - 1);}
+            slots[s] = u;
+        }
+    } else {
+        uint64_t s = Model::hashName(name.start, name.length);
+        s &= slots.size() - 1;
+        while (slots[s] != NONE) {s = (s + 1) & (slots.size() - 1);}
+        slots[s] = v;
+    }
+}
+/*
+ * addParents()
+ * Purpose:     records the parents of a variable
+ * Parameters:  none
+ * Returns:     none
+ */
+void Parser::addParents()
+{
+    int child = find(tokens[0]);
+    if (child == NONE) {error(tokens[0].start, "unknown variable");}
+    if (hasParents[child]) {error(tokens[0].start, "parents given twice");}
+    hasParents[child] = true;
+    for (size_t i = 1; i < tokens.size(); i++) {
+        int p = find(tokens[i]);
+        if (p == NONE) {error(tokens[i].start, "unknown variable");}
+        if (p == child) {error(tokens[i].start, "variable is its own parent");}
+        edges.push_back(child);
+        edges.push_back(p);
+    }
+}
+/*
+ * finishStructure()
+ * Purpose:     groups the parents by child and builds the model, leaving
+ *              its CPTs to be filled, once the parents are known
+ * Parameters:  tables of the variables read
+ * Returns:     none
+ */
+void Parser::finishStructure(Model::Tables &t)
+{
+    int n = names.size();
+    t.parentStart.assign(n + 1, 0);
+    for (size_t e = 0; e < edges.size(); e += 2) {
+        t.parentStart[edges[e] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        t.parentStart[v + 1] += t.parentStart[v];
+    }
+    t.parents.resize(edges.size() / 2);
+    vector<int32_t> fill(t.parentStart.begin(), t.parentStart.end() - 1);
+    for (size_t e = 0; e < edges.size(); e += 2) { // in the order given
+        t.parents[fill[edges[e]]++] = edges[e + 1];
+    }
+    vector<int32_t>().swap(edges);
+    model->build(t);
+    cpt = model->fillCPT();
+    valueStart.push_back(values.size()); // values of v end at valueStart[v + 1]
+    rowRead.assign(model->getCPT(n) - model->getCPT(0), false); // by 1st entry
+    cptLine.assign(n, 0);
+}
+/*
+ * addRow()
+ * Purpose:     writes a row of a CPT to its place in the model, checking
+ *              that its probabilities add up to 1
+ * Parameters:  the variable the row belongs to
+ * Returns:     none
+ */
+void Parser::addRow(int var)
+{
+    int numP = model->getNumParents(var);
+    const int *ps = model->getParents(var);
+    const int *strides = model->getStrides(var);
+    int card = model->getNumVal(var);
+    int given = tokens.size() - numP;
+    if (given != card - 1 and given != card) {
+        error(tokens[0].start, "expected " + to_string(numP) +
+              " parent values and " + to_string(card - 1) + " probabilities");
+    }
+    int64_t row = 0;
+    for (int i = 0; i < numP; i++) {
+        int p = ps[i];
+        int value = findValue(p, tokens[i]);
+        if (value == NONE) {
+            error(tokens[i].start, "not a value of " +
+                  string(names[p].start, names[p].length));
+        }
+        row += value * strides[i];
+    }
+    int64_t at = (model->getCPT(var) - cpt) + row * card;
+    if (rowRead[at]) {error(tokens[0].start, "CPT row given twice");}
+    rowRead[at] = true;
+    double total = 0;
+    for (int k = 0; k < given; k++) {
+        double p = number(tokens[numP + k]);
+        if (p < 0 or p > 1) {
+            error(tokens[numP + k].start, "probability out of range");
+        }
+        cpt[at + k] = p;
+        total += p;
+    }
+    if (given == card - 1 and total > 1 + ROW_TOLERANCE) {
+        error(tokens[numP].start, "probabilities add up to more than 1");
+    }
+    if (given == card - 1) { // the last probability is implied
+        cpt[at + card - 1] = max(1 - total, 0.0);
+    } else if (fabs(total - 1) > ROW_TOLERANCE) {
+        error(tokens[numP].start, "probabilities do not add up to 1");
+    }
+}
+/*
+ * checkCPTs()
+ * Purpose:     reports a variable whose CPT is missing or incomplete
+ * Parameters:  none
+ * Returns:     none
+ */
+void Parser::checkCPTs() const
+{
+    for (size_t v = 0; v < names.size(); v++) {
+        if (cptLine[v] == 0) {
+            error(lineNum + 1, "no CPT for " +
+                  string(names[v].start, names[v].length));
+        }
+        int64_t first = model->getCPT(v) - cpt;
+        int64_t last = model->getCPT(v + 1) - cpt;
+        for (int64_t at = first; at < last; at += model->getNumVal(v)) {
+            if (!rowRead[at]) {
+                error(cptLine[v], "CPT of " +
+                      string(names[v].start, names[v].length) +
+                      " is missing rows");
+            }
+        }
+    }
+}
+/*
+ * find()
+ * Purpose:     looks up a variable by name
+ * Parameters:  name
+ * Returns:     variable ID, or NONE if there is no such variable
+ */
+int Parser::find(const Token &name) const
+{
+    if (slots.empty()) {return NONE;}
+    uint64_t mask = slots.size() - 1;
+    uint64_t s = Model::hashName(name.start, name.length) & mask;
+    while (slots[s] != NONE) { // linear probing
+        const Token &other = names[slots[s]];
+        if (other.length == name.length and
+            memcmp(other.start, name.start, name.length) == 0) {
+            return slots[s];
+        }
+        s = (s + 1) & mask;
+    }
+    return NONE;
+}
+/*
+ * findValue()
+ * Purpose:     looks up one of a variable's values by name
+ * Parameters:  variable ID and value name
+ * Returns:     value ID, or NONE if the variable has no such value
+ */
+int Parser::findValue(int var, const Token &value) const
+{
+    for (int k = valueStart[var]; k < valueStart[var + 1]; k++) {
+        if (values[k].length == value.length and
+            memcmp(values[k].start, value.start, value.length) == 0) {
+            return k - valueStart[var];
+        }
+    }
+    return NONE;
+}
+/*
+ * number()
+ * Purpose:     parses a decimal number. Numbers with at most 19 significant
+ *              digits and a power of ten up to 22 are computed exactly from
+ *              their digits (one rounding); the rest go through strtod.
+ * Parameters:  word holding the number
+ * Returns:     value
+ */
+double Parser::number(const Token &word) const
+{
+    const char *p = word.start;
+    const char *stop = p + word.length;
+    bool negative = false;
+    if (*p == '-' or *p == '+') {negative = (*p++ == '-');}
+    uint64_t digits = 0;
+    int numDigits = 0;  // significant digits in digits
+    int exponent = 0;
+    bool any = false;
+    bool exact = true;
+    for (; p < stop and isDigit(*p); p++) {
+        any = true;
+        if (numDigits < MAX_DIGITS) {
+            digits = digits * 10 + (*p - '0');
+            if (digits != 0) {numDigits++;}
+        } else {
+            exponent++;
+            exact = exact and *p == '0';
+        }
+    }
+    if (p < stop and *p == '.') {
+        for (p++; p < stop and isDigit(*p); p++) {
+            any = true;
+            if (numDigits < MAX_DIGITS) {
+                digits = digits * 10 + (*p - '0');
+                if (digits != 0) {numDigits++;}
+                exponent--;
+            } else {
+                exact = exact and *p == '0';
+            }
+        }
+    }
+    if (!any) {error(word.start, "expected a number");}
+    if (p < stop and (*p == 'e' or *p == 'E')) {
+        p++;
+        bool down = false;
+        if (p < stop and (*p == '-' or *p == '+')) {down = (*p++ == '-');}
+        if (p == stop or !isDigit(*p)) {error(p, "malformed exponent");}
+        int e = 0;
+        for (; p < stop and isDigit(*p); p++) {
+            if (e < 100000) {e = e * 10 + (*p - '0');}
+        }
+        exponent += down ? -e : e;
+    }
+    if (p != stop) {error(p, "malformed number");}
+
+    if (!exact or digits >= (1ULL << 53) or exponent < -22 or exponent > 22) {
+        return strtod(string(word.start, word.length).c_str(), NULL);
+    }
+    double value = (double)digits; // exact, so only the scaling rounds
+    value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+    return negative ? -value : value;
+}
+/*
+ * error()
+ * Purpose:     reports malformed input and exits
+ * Parameters:  position in the file, or line number, and what is wrong
+ * Returns:     none
+ */
+void Parser::error(const char *at, const string &message) const
+{
+    cerr << "Error: " << filename << ":" << lineNum << ":"
+         << (at - lineStart + 1) << ": " << message << "\n";
+    exit(EXIT_FAILURE);
+}
+void Parser::error(int line, const string &message) const
+{
+    cerr << "Error: " << filename << ":" << line << ": " << message << "\n";
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,73 @@
+/*
+ * Parser.h
+ * by: Valerie Zhang
+ *
+ * Purpose: The Parser class reads a network in the text format straight
+ *          into a Model. The file is memory-mapped and tokenized in place,
+ *          so no line or token is copied. Once the structure is read the
+ *          model is laid out at its final size, and every CPT row is
+ *          written to its place in it as soon as it is read. Malformed
+ *          input is reported with its line and column.
+ */
+#ifndef _PARSER_H_
+#define _PARSER_H_
+
+#include "Model.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Parser {
+public:
+    Parser();
+    ~Parser();
+
+    void parse(const string &filename, Model &model);
+
+private:
+    /* a word of the file, pointing into the mapping */
+    struct Token {
+        const char *start;
+        int length;
+    };
+
+    Parser(const Parser &other);
+    Parser &operator=(const Parser &other);
+
+    string filename;
+    void *mapping;
+    size_t length;
+    const char *pos;        // start of the next line
+    const char *end;        // end of the file
+    const char *lineStart;  // start of the current line
+    int lineNum;            // current line, from 1
+
+    vector<Token> tokens;   // words of the current line
+    vector<Token> names;    // variable names
+    vector<Token> values;   // value names, valueStart[v] onwards for v
+    vector<int> valueStart; // one past the last variable once laid out
+    vector<int32_t> slots;  // open-addressed hash table of variable IDs
+
+    vector<int32_t> edges;  // child and parent of each link, as read
+    vector<bool> hasParents;
+    Model *model;           // built once the structure is known
+    double *cpt;            // the model's CPTs, filled as rows are read
+    vector<int> cptLine;    // line of each CPT's name, 0 if not read yet
+    vector<bool> rowRead;   // CPT rows already read
+
+    bool nextLine();
+    void addVar(Model::Tables &t);
+    void addParents();
+    void finishStructure(Model::Tables &t);
+    void addRow(int var);
+    void checkCPTs() const;
+
+    int find(const Token &name) const;
+    int findValue(int var, const Token &value) const;
+    double number(const Token &word) const;
+    void error(const char *at, const string &message) const;
+    void error(int line, const string &message) const;
+};
+#endif
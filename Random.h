@@ -0,0 +1,60 @@
+/*
+ * Random.h
+ * by: Valerie Zhang
+ *
+ * Purpose: A small, fast random number generator (xoshiro256**) for the
+ *          sampling engines. Each task owns one, seeded from the query's
+ *          seed and the task's number, so results do not depend on which
+ *          thread ran the task.
+ */
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include <stdint.h>
+
+class Random {
+public:
+    /*
+     * constructor
+     * Purpose:     fills the state from a seed and a stream number with
+     *              splitmix64, so nearby seeds give unrelated streams
+     */
+    Random(uint64_t seed, uint64_t stream = 0)
+    {
+        uint64_t x = seed ^ (stream * 0xd1342543de82ef95ULL);
+        for (int i = 0; i < 4; i++) {
+            x += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+    /*
+     * next()
+     * Purpose:     next 64 random bits
+     */
+    uint64_t next()
+    {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+    /*
+     * uniform()
+     * Purpose:     uniform double in [0, 1), from the top 53 bits
+     */
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+#endif
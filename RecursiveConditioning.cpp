@@ -0,0 +1,274 @@
+/*
+ * RecursiveConditioning.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of RecursiveConditioning class.
+ */
+#include "RecursiveConditioning.h"
+#include "LogSpace.h"
+#include <algorithm>
+#include <cfloat>
+
+using namespace std;
+
+static const double EMPTY = DBL_MAX; // no result, nor log of one, gets here
+
+/*
+ * constructor
+ */
+RecursiveConditioning::RecursiveConditioning(const Model &m, Heuristic h,
+                                             size_t cacheBytes)
+    : Engine(m)
+{
+    root = NONE;
+    cacheEntries = 0;
+    build(h);
+    if (root != NONE) {
+        setCutsets(root, vector<int>());
+        allotCaches(cacheBytes);
+    }
+}
+/*
+ * build()
+ * Purpose:     builds a dtree with one leaf per CPT by following an
+ *              elimination order: eliminating a variable joins every tree
+ *              that mentions it
+ * Parameters:  elimination ordering heuristic
+ * Returns:     none
+ */
+void RecursiveConditioning::build(Heuristic h)
+{
+    int n = model.numVars();
+    vector<int> forest;
+    for (int v = 0; v < n; v++) { // leaf v holds the CPT of v
+        DNode leaf;
+        leaf.left = leaf.right = NONE;
+        leaf.var = v;
+        leaf.vars.assign(model.getParents(v), model.getParents(v) + model.getNumParents(v));
+        leaf.vars.push_back(v);
+        sort(leaf.vars.begin(), leaf.vars.end());
+        leaf.cacheStart = leaf.cacheSize = 0;
+        nodes.push_back(leaf);
+        forest.push_back(v);
+    }
+    vector<bool> all(n, true);
+    vector<int> order = eliminationOrder(model, all, all, h);
+    order.push_back(NONE); // finally join whatever is left
+    for (size_t i = 0; i < order.size(); i++) {
+        int joined = NONE;
+        vector<int> rest;
+        for (size_t j = 0; j < forest.size(); j++) {
+            const vector<int> &vars = nodes[forest[j]].vars;
+            if (order[i] != NONE and
+                !binary_search(vars.begin(), vars.end(), order[i])) {
+                rest.push_back(forest[j]);
+            } else if (joined == NONE) {
+                joined = forest[j];
+            } else {
+                DNode node;
+                node.left = joined;
+                node.right = forest[j];
+                node.var = NONE;
+                const vector<int> &a = nodes[joined].vars;
+                set_union(a.begin(), a.end(), vars.begin(), vars.end(),
+                          back_inserter(node.vars));
+                node.cacheStart = node.cacheSize = 0;
+                joined = nodes.size();
+                nodes.push_back(node);
+            }
+        }
+        if (joined != NONE) {rest.push_back(joined);}
+        forest = rest;
+    }
+    if (!forest.empty()) {root = forest[0];}
+}
+/*
+ * setCutsets()
+ * Purpose:     finds the cutset and context of every node below t
+ * Parameters:  node and the union of its ancestors' cutsets
+ * Returns:     none
+ */
+void RecursiveConditioning::setCutsets(int t, const vector<int> &acutset)
+{
+    DNode &d = nodes[t];
+    set_intersection(d.vars.begin(), d.vars.end(), acutset.begin(),
+                     acutset.end(), back_inserter(d.context));
+    if (d.left == NONE) {return;}
+    const vector<int> &l = nodes[d.left].vars;
+    const vector<int> &r = nodes[d.right].vars;
+    vector<int> shared;
+    set_intersection(l.begin(), l.end(), r.begin(), r.end(),
+                     back_inserter(shared));
+    set_difference(shared.begin(), shared.end(), acutset.begin(),
+                   acutset.end(), back_inserter(d.cutset));
+    vector<int> below;
+    set_union(acutset.begin(), acutset.end(), d.cutset.begin(),
+              d.cutset.end(), back_inserter(below));
+    int left = d.left, right = d.right; // d may move as nodes grow
+    setCutsets(left, below);
+    setCutsets(right, below);
+}
+/*
+ * allotCaches()
+ * Purpose:     gives caches to the nodes that save the most calls per
+ *              cache entry, until the memory budget is used up
+ * Parameters:  budget in bytes
+ * Returns:     none
+ */
+void RecursiveConditioning::allotCaches(size_t cacheBytes)
+{
+    // a node is called once per instantiation of its ancestors' cutsets
+    // but only has one result per instantiation of its context
+    vector<double> calls(nodes.size(), 1), entries(nodes.size(), 1);
+    vector<pair<double, int>> ranked;
+    vector<int> stack(1, root);
+    while (!stack.empty()) {
+        int t = stack.back();
+        stack.pop_back();
+        DNode &d = nodes[t];
+        for (size_t i = 0; i < d.context.size(); i++) {
+            entries[t] *= model.getNumVal(d.context[i]);
+        }
+        if (d.left == NONE) {continue;}
+        double below = calls[t];
+        for (size_t i = 0; i < d.cutset.size(); i++) {
+            below *= model.getNumVal(d.cutset[i]);
+        }
+        calls[d.left] = calls[d.right] = below;
+        stack.push_back(d.left);
+        stack.push_back(d.right);
+        if (calls[t] > entries[t]) {
+            ranked.push_back(make_pair(calls[t] / entries[t], t));
+        }
+    }
+    sort(ranked.rbegin(), ranked.rend());
+    size_t total = 0;
+    for (size_t i = 0; i < ranked.size(); i++) {
+        int t = ranked[i].second;
+        double bytes = entries[t] * sizeof(double);
+        if (total + bytes > cacheBytes) {continue;}
+        nodes[t].cacheStart = total / sizeof(double);
+        nodes[t].cacheSize = entries[t];
+        total += bytes;
+    }
+    cacheEntries = total / sizeof(double);
+}
+/*
+ * ask()
+ * Purpose:     computes P(query = xi, evidence) for every xi
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
+ */
+void RecursiveConditioning::ask(QueryContext &ctx, int query,
+                                const vector<int> &evidence,
+                                vector<double> &dist) const
+{
+    Context &c = static_cast<Context &>(ctx);
+    vector<int> assignment = evidence;
+    dist.assign(model.getNumVal(query), 0);
+    if (c.cache.size() != cacheEntries) {c.cache.assign(cacheEntries, EMPTY);}
+    forget(c, NONE); // cached results depend on the evidence
+    if (!relevant(query, assignment, c.needed)) {return;}
+    propagate(query, c.needed, assignment);
+    for (int i = 0; i < model.getNumVal(query); i++) {
+        if (i > 0) {forget(c, query);}
+        assignment[query] = i;
+        dist[i] = rc(c, root, assignment);
+    }
+    if (logSpace) {logToLinear(dist);}
+}
+/*
+ * forget()
+ * Purpose:     empties the cache slots written so far that depend on a
+ *              variable, so clearing costs the results computed rather
+ *              than the whole cache
+ * Parameters:  context and variable, NONE for every slot
+ * Returns:     none
+ */
+void RecursiveConditioning::forget(Context &ctx, int var) const
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < ctx.written.size(); i++) {
+        const vector<int> &vars = nodes[ctx.written[i].first].vars;
+        if (var == NONE or binary_search(vars.begin(), vars.end(), var)) {
+            ctx.cache[ctx.written[i].second] = EMPTY;
+        } else { // no CPT below the node mentions it
+            ctx.written[kept++] = ctx.written[i];
+        }
+    }
+    ctx.written.resize(kept);
+}
+/*
+ * rc()
+ * Purpose:     computes the probability of the CPTs below a node under the
+ *              current assignment, summing over its free variables
+ * Parameters:  query context, node and assignment (the node's context
+ *              variables must be assigned)
+ * Returns:     probability, or its log in log space
+ */
+double RecursiveConditioning::rc(Context &ctx, int t,
+                                 vector<int> &assignment) const
+{
+    const DNode &d = nodes[t];
+    vector<double> &cache = ctx.cache;
+    if (d.left == NONE) {
+        if (!ctx.needed[d.var] or assignment[d.var] == NONE) {
+            return logSpace ? 0.0 : 1.0; // not needed, or a row summing to 1
+        }
+        double p = model.getProbability(d.var, assignment.data());
+        return logSpace ? logOf(p) : p;
+    }
+    size_t slot = 0;
+    if (d.cacheSize > 0) {
+        size_t index = 0;
+        for (size_t i = 0; i < d.context.size(); i++) {
+            int c = d.context[i]; // pruned variables are left at NONE
+            index = index * model.getNumVal(c) + max(assignment[c], 0);
+        }
+        slot = d.cacheStart + index;
+        if (cache[slot] != EMPTY) {return cache[slot];}
+    }
+    double result = condition(ctx, t, 0, assignment);
+    if (d.cacheSize > 0) {
+        cache[slot] = result;
+        ctx.written.push_back(make_pair(t, slot));
+    }
+    return result;
+}
+/*
+ * condition()
+ * Purpose:     sums over the values of the node's cutset variables from
+ *              position k on, multiplying its two halves for each
+ * Parameters:  query context, node, position in its cutset and assignment
+ * Returns:     sum, or its log in log space
+ */
+double RecursiveConditioning::condition(Context &ctx, int t, size_t k,
+                                        vector<int> &assignment) const
+{
+    const DNode &d = nodes[t];
+    if (k == d.cutset.size()) {
+        double left = rc(ctx, d.left, assignment);
+        double right = rc(ctx, d.right, assignment);
+        return logSpace ? logTimes(left, right) : left * right;
+    }
+    int c = d.cutset[k];
+    if (assignment[c] != NONE or !ctx.needed[c]) { // evidence, query or pruned
+        return condition(ctx, t, k + 1, assignment);
+    }
+    if (logSpace) {
+        LogSum sum;
+        for (int i = 0; i < model.getNumVal(c); i++) {
+            assignment[c] = i;
+            sum.add(condition(ctx, t, k + 1, assignment));
+        }
+        assignment[c] = NONE;
+        return sum.value();
+    }
+    double sum = 0;
+    for (int i = 0; i < model.getNumVal(c); i++) {
+        assignment[c] = i;
+        sum += condition(ctx, t, k + 1, assignment);
+    }
+    assignment[c] = NONE;
+    return sum;
+}
@@ -0,0 +1,56 @@
+/*
+ * RecursiveConditioning.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Recursive conditioning over a dtree. Conditioning on each
+ *          node's cutset splits the network into independent halves;
+ *          results of a node are cached on the values of its context (the
+ *          only variables its result depends on). The cache memory budget
+ *          picks anything between zero-memory search and a full table.
+ */
+#ifndef _RECURSIVECONDITIONING_H_
+#define _RECURSIVECONDITIONING_H_
+
+#include "Engine.h"
+#include "Ordering.h"
+
+using namespace std;
+
+class RecursiveConditioning : public Engine {
+public:
+    RecursiveConditioning(const Model &m, Heuristic h, size_t cacheBytes);
+
+    QueryContext *newContext() const { return new Context(); }
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+
+private:
+    /* a query's cached subproblem results */
+    struct Context : public QueryContext {
+        vector<double> cache;     // EMPTY marks an empty slot
+        vector<pair<int, size_t>> written; // node and slot of each result
+    };
+
+    struct DNode {
+        int left, right;      // children, NONE for a leaf
+        int var;              // leaf: variable whose CPT it holds
+        vector<int> vars;     // variables of every CPT below (sorted)
+        vector<int> cutset;
+        vector<int> context;
+        size_t cacheStart;    // first cache slot, if cached
+        size_t cacheSize;     // 0 if the node is not cached
+    };
+
+    vector<DNode> nodes;
+    int root;
+    size_t cacheEntries;      // slots of all the nodes' caches
+
+    void build(Heuristic h);
+    void setCutsets(int t, const vector<int> &acutset);
+    void allotCaches(size_t cacheBytes);
+    double rc(Context &ctx, int t, vector<int> &assignment) const;
+    double condition(Context &ctx, int t, size_t k,
+                     vector<int> &assignment) const;
+    void forget(Context &ctx, int query) const;
+};
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Relevance.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of relevance pruning with the Bayes-ball
+ *          algorithm (Shachter 1998).
+ */
+#include "Relevance.h"
+#include <utility>
+
+using namespace std;
+
+/*
+ * relevantNetwork()
+ * Purpose:     bounces a ball from the query through the network. Evidence
+ *              the ball never reaches is d-separated from the query and is
+ *              dropped. Only variables the ball leaves through their
+ *              parents have CPTs the answer depends on; everything else
+ *              (barren variables, ancestors cut off by evidence, ...) can
+ *              be skipped.
+ * Parameters:  model, query variable, evidence (d-separated entries are
+ *              reset to NONE) and vector to fill with whether each
+ *              variable's CPT is needed
+ * Returns:     none
+ *
+ * The parents of a needed variable are always needed or evidence, so
+ * engines can treat the needed variables as a smaller network.
+ */
+void relevantNetwork(const Model &m, int query, vector<int> &evidence,
+                     vector<bool> &needed)
+{
+    int n = m.numVars();
+    vector<bool> visited(n, false), top(n, false), bottom(n, false);
+    vector<pair<int, bool>> schedule; // (variable, ball came from a child)
+    schedule.push_back(make_pair(query, true));
+    while (!schedule.empty()) {
+        int v = schedule.back().first;
+        bool fromChild = schedule.back().second;
+        schedule.pop_back();
+        visited[v] = true;
+        bool observed = evidence[v] != NONE;
+        bool passUp = false, passDown = false;
+        if (fromChild and !observed) { // hidden: passes to both sides
+            passUp = passDown = true;
+        } else if (!fromChild) {       // from a parent
+            passUp = observed;         // evidence bounces back up
+            passDown = !observed;
+        }
+        if (passUp and !top[v]) {
+            top[v] = true;
+            for (int i = 0; i < m.getNumParents(v); i++) {
+                schedule.push_back(make_pair(m.getParents(v)[i], true));
+            }
+        }
+        if (passDown and !bottom[v]) {
+            bottom[v] = true;
+            for (int i = 0; i < m.getNumChildren(v); i++) {
+                schedule.push_back(make_pair(m.getChildren(v)[i], false));
+            }
+        }
+    }
+    needed = top;
+    for (int v = 0; v < n; v++) {
+        if (!visited[v]) {evidence[v] = NONE;}
+    }
+}
+/*
+ * possibleEvidence()
+ * Purpose:     unit propagation over the whole network, in topological
+ *              order: a hidden variable whose parents are all known and
+ *              force its value takes it, and an observed one whose value
+ *              has probability 0 given its known parents makes the
+ *              evidence impossible. Run before pruning, since evidence
+ *              that is d-separated from the query is dropped unread.
+ * Parameters:  model and evidence
+ * Returns:     false if the evidence is shown impossible; true does not
+ *              prove it possible
+ */
+bool possibleEvidence(const Model &m, const vector<int> &evidence)
+{
+    vector<int> known = evidence;
+    for (int i = 0; i < m.numVars(); i++) {
+        int v = m.getOrder()[i];
+        bool ready = true;
+        for (int k = 0; k < m.getNumParents(v) and ready; k++) {
+            ready = known[m.getParents(v)[k]] != NONE;
+        }
+        if (!ready) {continue;}
+        if (known[v] == NONE) {
+            known[v] = m.getForced(v, known.data());
+        } else if (m.getProbability(v, known.data()) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+/*
+ * Relevance.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Query-time pruning. Finds the part of the network a query
+ *          actually depends on, so the engines can skip the rest, after
+ *          checking that the evidence it drops is not impossible.
+ */
+#ifndef _RELEVANCE_H_
+#define _RELEVANCE_H_
+
+#include "Model.h"
+#include <vector>
+
+using namespace std;
+
+void relevantNetwork(const Model &m, int query, vector<int> &evidence,
+                     vector<bool> &needed);
+bool possibleEvidence(const Model &m, const vector<int> &evidence);
+#endif
@@ -0,0 +1,160 @@
+/*
+ * ResultCache.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of ResultCache class.
+ */
+#include "ResultCache.h"
+
+using namespace std;
+
+/*
+ * constructor
+ */
+ResultCache::ResultCache(size_t cap)
+{
+    capacity = cap;
+    hits = misses = gen = 0;
+}
+/*
+ * makeKey()
+ * Purpose:     builds the canonical key of a query: the query variable
+ *              followed by each evidence variable and value in ID order
+ * Parameters:  query variable and evidence (a value ID or -1 per variable)
+ * Returns:     key
+ */
+string ResultCache::makeKey(int query, const vector<int> &evidence)
+{
+    string key = to_string(query) + "|";
+    for (size_t v = 0; v < evidence.size(); v++) {
+        if (evidence[v] >= 0) {
+            key += to_string(v) + "=" + to_string(evidence[v]) + ",";
+        }
+    }
+    return key;
+}
+/*
+ * get()
+ * Purpose:     looks up a result and marks it most recently used
+ * Parameters:  key and distribution to fill
+ * Returns:     true on a hit, false on a miss
+ */
+bool ResultCache::get(const string &key, vector<double> &dist)
+{
+    lock_guard<mutex> guard(lock);
+    unordered_map<string, Entries::iterator>::iterator it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    dist = it->second->second;
+    hits++;
+    return true;
+}
+/*
+ * put()
+ * Purpose:     stores a result, evicting the least recently used ones
+ *              when full
+ * Parameters:  key, distribution and the generation() read before the
+ *              result was computed
+ * Returns:     none
+ */
+void ResultCache::put(const string &key, const vector<double> &dist,
+                      unsigned long g)
+{
+    lock_guard<mutex> guard(lock);
+    if (capacity == 0 or g != gen) {return;} // disabled, or model reloaded
+    unordered_map<string, Entries::iterator>::iterator it = index.find(key);
+    if (it != index.end()) {
+        it->second->second = dist;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.push_front(make_pair(key, dist));
+    index[key] = entries.begin();
+    evict();
+}
+/*
+ * clear()
+ * Purpose:     drops every result, e.g. when the model is reloaded
+ * Parameters:  none
+ * Returns:     none
+ */
+void ResultCache::clear()
+{
+    lock_guard<mutex> guard(lock);
+    entries.clear();
+    index.clear();
+    gen++;
+}
+/*
+ * setCapacity()
+ * Purpose:     changes the maximum number of results kept
+ * Parameters:  capacity (0 disables the cache)
+ * Returns:     none
+ */
+void ResultCache::setCapacity(size_t cap)
+{
+    lock_guard<mutex> guard(lock);
+    capacity = cap;
+    evict();
+}
+/*
+ * evict()
+ * Purpose:     drops least recently used results until within capacity;
+ *              the lock must be held
+ * Parameters:  none
+ * Returns:     none
+ */
+void ResultCache::evict()
+{
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+/*
+ * generation()
+ * Purpose:     get number of times the cache has been cleared
+ * Parameters:  none
+ * Returns:     generation
+ */
+unsigned long ResultCache::generation()
+{
+    lock_guard<mutex> guard(lock);
+    return gen;
+}
+/*
+ * getHits()
+ * Purpose:     get number of lookups that found a result
+ * Parameters:  none
+ * Returns:     hits
+ */
+unsigned long ResultCache::getHits()
+{
+    lock_guard<mutex> guard(lock);
+    return hits;
+}
+/*
+ * getMisses()
+ * Purpose:     get number of lookups that found nothing
+ * Parameters:  none
+ * Returns:     misses
+ */
+unsigned long ResultCache::getMisses()
+{
+    lock_guard<mutex> guard(lock);
+    return misses;
+}
+/*
+ * size()
+ * Purpose:     get number of results stored
+ * Parameters:  none
+ * Returns:     number of results
+ */
+size_t ResultCache::size()
+{
+    lock_guard<mutex> guard(lock);
+    return entries.size();
+}
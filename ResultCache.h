@@ -0,0 +1,52 @@
+/*
+ * ResultCache.h
+ * by: Valerie Zhang
+ *
+ * Purpose: A bounded LRU cache of query results that can be shared by
+ *          several threads. Results are keyed on the query variable and
+ *          its evidence, so the order evidence was typed in does not
+ *          matter.
+ */
+#ifndef _RESULTCACHE_H_
+#define _RESULTCACHE_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class ResultCache {
+public:
+    ResultCache(size_t capacity);
+
+    static string makeKey(int query, const vector<int> &evidence);
+
+    bool get(const string &key, vector<double> &dist);
+    void put(const string &key, const vector<double> &dist,
+             unsigned long gen);
+    void clear();
+    void setCapacity(size_t capacity);
+
+    unsigned long generation();
+    unsigned long getHits();
+    unsigned long getMisses();
+    size_t size();
+
+private:
+    typedef list<pair<string, vector<double>>> Entries;
+
+    mutex lock;
+    size_t capacity;
+    Entries entries; // most recently used first
+    unordered_map<string, Entries::iterator> index;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long gen; // bumped by clear() so stale results are dropped
+
+    void evict();
+};
+#endif
@@ -0,0 +1,369 @@
+/*
+ * Server.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Server class.
+ */
+#include "Server.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+static const int MAX_PIPELINE = 256;      // requests in flight per client
+static const size_t MAX_LINE = 1 << 20;   // longest request line
+static const int SEND_TIMEOUT_SECONDS = 10;
+
+static int wakeWrite = -1; // write end of the pipe signals wake run() with
+
+/*
+ * onSignal()
+ * Purpose:     signal handler for SIGINT and SIGTERM: wakes the accept loop
+ *              so the server drains and returns
+ */
+static void onSignal(int)
+{
+    int saved = errno;
+    if (write(wakeWrite, "x", 1) < 0) {} // nothing to do if the pipe is full
+    errno = saved;
+}
+
+/*
+ * constructor: listens on a TCP port of 127.0.0.1 if the address is a
+ *              number (0 picks a free one), otherwise on a Unix socket at
+ *              that path
+ */
+Server::Server(string address, ThreadPool &p, Handler h)
+    : pool(p), handler(h), listener(-1), port(0), closedWrite(-1)
+{
+    if (!address.empty() and
+        address.find_first_not_of("0123456789") == string::npos) {
+        listenTCP(atoi(address.c_str()));
+    } else {
+        listenUnix(address);
+    }
+}
+/*
+ * destructor: closes the listening socket
+ */
+Server::~Server()
+{
+    if (listener >= 0) {close(listener);}
+    if (!unixPath.empty()) {unlink(unixPath.c_str());}
+}
+/*
+ * listenUnix()
+ * Purpose:     binds a Unix domain socket, replacing a stale socket file
+ *              left at the path
+ * Parameters:  path
+ * Returns:     none; exits on failure
+ */
+void Server::listenUnix(string path)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() or path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Error: bad socket path \"" << path << "\"\n";
+        exit(EXIT_FAILURE);
+    }
+    strcpy(addr.sun_path, path.c_str());
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 and S_ISSOCK(st.st_mode)) {
+        unlink(path.c_str());
+    }
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 or bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0
+        or listen(listener, SOMAXCONN) < 0) {
+        cerr << "Error: could not listen on " << path << ": "
+             << strerror(errno) << "\n";
+        exit(EXIT_FAILURE);
+    }
+    unixPath = path;
+}
+/*
+ * listenTCP()
+ * Purpose:     binds a TCP socket on the loopback interface only
+ * Parameters:  port, 0 for any free one
+ * Returns:     none; exits on failure
+ */
+void Server::listenTCP(int p)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(p);
+    int on = 1;
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    socklen_t len = sizeof(addr);
+    if (listener < 0 or
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 or
+        bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 or
+        listen(listener, SOMAXCONN) < 0 or
+        getsockname(listener, (sockaddr *)&addr, &len) < 0) {
+        cerr << "Error: could not listen on port " << p << ": "
+             << strerror(errno) << "\n";
+        exit(EXIT_FAILURE);
+    }
+    port = ntohs(addr.sin_port);
+}
+/*
+ * describe()
+ * Purpose:     where clients connect
+ * Parameters:  none
+ * Returns:     the socket path, or 127.0.0.1:port
+ */
+string Server::describe() const
+{
+    return unixPath.empty() ? "127.0.0.1:" + to_string(port) : unixPath;
+}
+/*
+ * run()
+ * Purpose:     accepts connections until SIGINT or SIGTERM, then stops
+ *              reading requests and waits for the ones already read to be
+ *              answered and sent
+ * Parameters:  none
+ * Returns:     none
+ */
+void Server::run()
+{
+    int wake[2], closed[2];
+    if (pipe(wake) < 0 or pipe(closed) < 0) {
+        cerr << "Error: could not create a pipe: " << strerror(errno) << "\n";
+        exit(EXIT_FAILURE);
+    }
+    wakeWrite = wake[1];
+    closedWrite = closed[1];
+    fcntl(closed[1], F_SETFL, O_NONBLOCK); // a full pipe already wakes run()
+    struct sigaction action, oldInt, oldTerm;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, &oldInt);
+    sigaction(SIGTERM, &action, &oldTerm);
+    signal(SIGPIPE, SIG_IGN); // a vanished client is noticed by send()
+
+    while (true) {
+        pollfd fds[3];
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        fds[1].fd = wake[0];
+        fds[1].events = POLLIN;
+        fds[2].fd = closed[0];
+        fds[2].events = POLLIN;
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) {continue;}
+            break;
+        }
+        if (fds[1].revents != 0) {break;}
+        if (fds[2].revents != 0) { // free closed connections right away
+            char drained[64];
+            if (read(closed[0], drained, sizeof(drained)) < 0) {}
+            reap(false);
+        }
+        if (!(fds[0].revents & POLLIN)) {continue;}
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {continue;}
+        timeval timeout = {SEND_TIMEOUT_SECONDS, 0};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        Connection *c = new Connection();
+        c->fd = fd;
+        c->next = 0;
+        c->pending = 0;
+        c->reading = true;
+        c->finished = false;
+        connections.push_back(c);
+        c->writer = thread(&Server::sendReplies, this, c);
+        c->reader = thread(&Server::serve, this, c);
+    }
+
+    // drain: no new connections, no new requests, finish the rest
+    close(listener);
+    listener = -1;
+    for (size_t i = 0; i < connections.size(); i++) {
+        shutdown(connections[i]->fd, SHUT_RD); // wakes its reader
+    }
+    reap(true);
+    sigaction(SIGINT, &oldInt, NULL);
+    sigaction(SIGTERM, &oldTerm, NULL);
+    wakeWrite = -1;
+    closedWrite = -1;
+    close(wake[0]);
+    close(wake[1]);
+    close(closed[0]);
+    close(closed[1]);
+}
+/*
+ * serve()
+ * Purpose:     reader thread of a connection: queues each request line on
+ *              the pool as it arrives, until the client closes, sends
+ *              "quit", or the server drains; then waits for the writer to
+ *              send the replies, closes the connection and tells run()
+ * Parameters:  connection
+ * Returns:     none
+ */
+void Server::serve(Connection *c)
+{
+    string buffer;
+    char chunk[4096];
+    uint64_t seq = 0;
+    bool quit = false;
+    while (!quit) {
+        ssize_t n = read(c->fd, chunk, sizeof(chunk));
+        if (n < 0 and errno == EINTR) {continue;}
+        if (n <= 0) {break;}
+        buffer.append(chunk, n);
+        size_t start = 0, end;
+        while (!quit and (end = buffer.find('\n', start)) != string::npos) {
+            string line = buffer.substr(start, end - start);
+            start = end + 1;
+            if (!line.empty() and line[line.size() - 1] == '\r') {
+                line.erase(line.size() - 1);
+            }
+            if (line.empty()) {continue;}
+            if (line == "quit") {
+                quit = true;
+                break;
+            }
+            {
+                unique_lock<mutex> guard(c->lock);
+                while (c->pending >= MAX_PIPELINE) {c->done.wait(guard);}
+                c->pending++;
+            }
+            uint64_t s = seq++;
+            pool.submit([this, c, s, line](int w) {
+                stringstream out;
+                handler(w, line, out);
+                reply(c, s, frame(out.str()));
+            });
+        }
+        buffer.erase(0, start);
+        if (buffer.size() > MAX_LINE) {break;} // no end of line in sight
+    }
+    {
+        lock_guard<mutex> guard(c->lock);
+        c->reading = false;
+    }
+    c->queued.notify_one();
+    c->writer.join();
+    shutdown(c->fd, SHUT_RDWR); // the client sees the end now
+    c->finished = true;
+    if (write(closedWrite, "x", 1) < 0) {} // run() reaps at its next wake
+}
+/*
+ * sendReplies()
+ * Purpose:     writer thread of a connection: sends the replies in request
+ *              order as they are handed in, outside the lock, until the
+ *              reader is done and every request has been replied to
+ * Parameters:  connection
+ * Returns:     none
+ */
+void Server::sendReplies(Connection *c)
+{
+    bool broken = false; // the client stopped reading: drop the rest
+    unique_lock<mutex> guard(c->lock);
+    while (true) {
+        c->queued.wait(guard, [c] {
+            return (!c->ready.empty() and c->ready.begin()->first == c->next)
+                   or (!c->reading and c->pending == 0);
+        });
+        if (c->ready.empty() or c->ready.begin()->first != c->next) {break;}
+        string text;
+        text.swap(c->ready.begin()->second);
+        c->ready.erase(c->ready.begin());
+        c->next++;
+        guard.unlock();
+        if (!broken) {broken = !sendAll(c->fd, text);}
+        guard.lock();
+        c->pending--;
+        c->done.notify_all();
+    }
+}
+/*
+ * reply()
+ * Purpose:     hands in the reply to a request for the writer to send
+ * Parameters:  connection, sequence number of the request and reply
+ * Returns:     none
+ */
+void Server::reply(Connection *c, uint64_t seq, const string &text)
+{
+    {
+        lock_guard<mutex> guard(c->lock);
+        c->ready[seq] = text;
+    }
+    c->queued.notify_one();
+}
+/*
+ * reap()
+ * Purpose:     joins and closes the connections whose readers are done
+ * Parameters:  whether to wait for every connection instead
+ * Returns:     none
+ */
+void Server::reap(bool all)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < connections.size(); i++) {
+        Connection *c = connections[i];
+        if (all or c->finished) {
+            c->reader.join();
+            close(c->fd); // only now, so its number cannot be reused early
+            delete c;
+        } else {
+            connections[kept++] = c;
+        }
+    }
+    connections.resize(kept);
+}
+/*
+ * frame()
+ * Purpose:     makes a reply end with its only blank line, so a client can
+ *              split replies on blank lines
+ * Parameters:  output of the handler
+ * Returns:     the reply
+ */
+string Server::frame(const string &text)
+{
+    string result;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\n' and (result.empty() or
+                                 result[result.size() - 1] == '\n')) {
+            continue;
+        }
+        result += text[i];
+    }
+    if (!result.empty() and result[result.size() - 1] != '\n') {
+        result += '\n';
+    }
+    return result + "\n";
+}
+/*
+ * sendAll()
+ * Purpose:     writes all of a string to a socket
+ * Parameters:  socket and text
+ * Returns:     false if the client is gone or stopped reading
+ */
+bool Server::sendAll(int fd, const string &text)
+{
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = send(fd, text.data() + sent, text.size() - sent,
+                         MSG_NOSIGNAL);
+        if (n < 0 and errno == EINTR) {continue;}
+        if (n <= 0) {return false;}
+        sent += n;
+    }
+    return true;
+}
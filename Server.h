@@ -0,0 +1,75 @@
+/*
+ * Server.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Serves request lines on a Unix domain socket or a localhost TCP
+ *          port. Every connection gets a thread that reads its lines and
+ *          queues each one on a shared ThreadPool as soon as it arrives, so
+ *          a client may send many requests without waiting (pipelining);
+ *          the replies go back in the order the requests came, sent by a
+ *          writer thread of the connection, so a client that reads slowly
+ *          holds up only itself and never a pool worker. On SIGINT or
+ *          SIGTERM the server stops accepting connections and requests,
+ *          finishes and sends every request already read, then returns.
+ */
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include "ThreadPool.h"
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class Server {
+public:
+    /* answers one request line, run by the given pool worker */
+    typedef function<void(int, const string &, ostream &)> Handler;
+
+    Server(string address, ThreadPool &pool, Handler handler);
+    ~Server();
+
+    string describe() const;
+    void run();
+
+private:
+    struct Connection {
+        int fd;
+        thread reader;
+        thread writer;
+        mutex lock;               // guards the fields below
+        condition_variable done;  // signalled when a reply is sent
+        condition_variable queued; // signalled when a reply is handed in
+        map<uint64_t, string> ready; // replies not yet sent
+        uint64_t next;            // sequence number of the next reply
+        int pending;              // requests read but not yet replied to
+        bool reading;             // the reader may still queue requests
+        atomic<bool> finished;    // the reader has exited
+    };
+
+    ThreadPool &pool;
+    Handler handler;
+    int listener;
+    string unixPath; // empty for TCP
+    int port;
+    vector<Connection *> connections;
+    int closedWrite; // a reader writes here when its connection is done
+
+    void listenUnix(string path);
+    void listenTCP(int port);
+    void serve(Connection *c);
+    void sendReplies(Connection *c);
+    void reply(Connection *c, uint64_t seq, const string &text);
+    void reap(bool all);
+    static string frame(const string &text);
+    static bool sendAll(int fd, const string &text);
+};
+#endif
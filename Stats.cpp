@@ -0,0 +1,164 @@
+/*
+ * Stats.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of Stats class.
+ */
+#include "Stats.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+using namespace std;
+
+__thread Stats::Block Stats::local;
+mutex Stats::registry;
+vector<Stats::Block *> Stats::blocks;
+Stats::Block Stats::retired;
+
+static const char *PHASE_NAMES[] = {"parse", "evidence", "inference",
+                                    "normalize", "print"};
+
+/*
+ * enabled()
+ * Purpose:     tells whether this build counts anything
+ * Parameters:  none
+ * Returns:     false unless built with make STATS=1
+ */
+bool Stats::enabled()
+{
+#ifdef STATS_ENABLED
+    return true;
+#else
+    return false;
+#endif
+}
+/*
+ * enroll()
+ * Purpose:     adds the calling thread's block to the ones reported, the
+ *              first time the thread counts
+ * Parameters:  none
+ * Returns:     none
+ */
+void Stats::enroll()
+{
+    static thread_local Retirer retirer; // runs retire() at thread exit
+    (void)retirer;
+    lock_guard<mutex> guard(registry);
+    blocks.push_back(&local);
+    local.enrolled = true;
+}
+/*
+ * retire()
+ * Purpose:     folds an exiting thread's counts into the retired sums and
+ *              forgets its block
+ * Parameters:  none
+ * Returns:     none
+ */
+void Stats::retire()
+{
+    lock_guard<mutex> guard(registry);
+    add(retired, local);
+    blocks.erase(remove(blocks.begin(), blocks.end(), &local), blocks.end());
+}
+/*
+ * add()
+ * Purpose:     adds one block's counts to a sum
+ * Parameters:  sum and block
+ * Returns:     none
+ */
+void Stats::add(Block &sum, const Block &b)
+{
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        sum.counts[c] += b.counts[c];
+    }
+    for (int p = 0; p < NUM_PHASES; p++) {
+        sum.nanos[p] += b.nanos[p];
+    }
+    sum.peakDepth = max(sum.peakDepth, b.peakDepth);
+}
+/*
+ * reset()
+ * Purpose:     zeroes every thread's counters, e.g. before a query. Only
+ *              called between queries, while no other thread is counting.
+ * Parameters:  none
+ * Returns:     none
+ */
+void Stats::reset()
+{
+    lock_guard<mutex> guard(registry);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        memset(blocks[i]->counts, 0, sizeof(blocks[i]->counts));
+        memset(blocks[i]->nanos, 0, sizeof(blocks[i]->nanos));
+        blocks[i]->peakDepth = 0;
+    }
+    memset(&retired, 0, sizeof(retired));
+}
+/*
+ * report()
+ * Purpose:     prints the counters summed over all threads since the last
+ *              reset. Only called between queries.
+ * Parameters:  stream
+ * Returns:     none
+ */
+void Stats::report(ostream &out)
+{
+    Block sum;
+    memset(&sum, 0, sizeof(sum));
+    {
+        lock_guard<mutex> guard(registry);
+        add(sum, retired);
+        for (size_t i = 0; i < blocks.size(); i++) {
+            add(sum, *blocks[i]);
+        }
+    }
+    const uint64_t *n = sum.counts;
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    out << fixed << setprecision(1) << "Time (us):";
+    for (int p = 0; p < NUM_PHASES; p++) {
+        out << (p > 0 ? "," : "") << " " << PHASE_NAMES[p] << " "
+            << sum.nanos[p] / 1000.0;
+    }
+    out << setprecision(2);
+    out << "\nEnumeration: " << n[ENUM_CALLS] << " eAll calls, peak depth "
+        << sum.peakDepth << ", " << n[SUMMATIONS] << " summations ("
+        << (n[SUMMATIONS] ? (double)n[SUMMATION_BRANCHES] / n[SUMMATIONS] : 0)
+        << " values each, " << n[ZERO_BRANCHES] << " skipped as 0), "
+        << n[FORCED_VALUES] << " values forced";
+    out << "\nLookups: " << n[CPT_LOOKUPS] << " CPT entries, "
+        << n[NAME_LOOKUPS] << " names ("
+        << (n[NAME_LOOKUPS] ? (double)n[NAME_PROBES] / n[NAME_LOOKUPS] : 0)
+        << " probes each)";
+    out << "\nFactors: " << n[FACTOR_OPS] << " operations writing "
+        << n[FACTOR_ENTRIES] << " entries";
+    out << "\nResult cache hits: " << n[CACHE_HITS] << "\n\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+/*
+ * Timer constructor
+ * Purpose:     starts timing a phase
+ */
+Stats::Timer::Timer(Phase p)
+{
+    if (!local.enrolled) {enroll();}
+    phase = p;
+    inner = 0;
+    outer = local.timer;
+    local.timer = this;
+    start = chrono::steady_clock::now();
+}
+/*
+ * Timer destructor
+ * Purpose:     adds the time since the timer started, less the time of
+ *              the timers nested in it, to its phase
+ */
+Stats::Timer::~Timer()
+{
+    uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(
+                      chrono::steady_clock::now() - start).count();
+    local.nanos[phase] += ns - inner;
+    if (outer != NULL) {outer->inner += ns;}
+    local.timer = outer;
+}
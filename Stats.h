@@ -0,0 +1,121 @@
+/*
+ * Stats.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Counters that explain where a query's time went: how often the
+ *          inner loops ran, how deep enumeration recursed, and the wall
+ *          time of each phase of answering it. Each thread counts into its
+ *          own block, so counting costs an add and takes no lock; a report
+ *          sums the blocks of every thread.
+ *
+ *          The code counts through the STAT_ macros below. They are
+ *          nothing unless the build defines STATS_ENABLED (make STATS=1),
+ *          so the default build has no counter in the inner loops.
+ */
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+using namespace std;
+
+class Stats {
+public:
+    enum Counter {
+        ENUM_CALLS,         // eAll calls
+        SUMMATIONS,         // hidden variables summed over
+        SUMMATION_BRANCHES, // values tried by those sums
+        ZERO_BRANCHES,      // of those, skipped for a probability of 0
+        FORCED_VALUES,      // hidden variables fixed by deterministic CPTs
+        CPT_LOOKUPS,        // conditional probabilities read
+        NAME_LOOKUPS,       // variable and value names looked up
+        NAME_PROBES,        // hash slots or values compared doing so
+        FACTOR_OPS,         // factor products, sum-outs and reductions
+        FACTOR_ENTRIES,     // entries those operations wrote
+        CACHE_HITS,         // queries answered from the result cache
+        NUM_COUNTERS
+    };
+    enum Phase {
+        PARSE,              // reading the query line
+        EVIDENCE,           // pruning the evidence and network
+        INFERENCE,          // the engine's own work
+        NORMALIZE,
+        PRINT,
+        NUM_PHASES
+    };
+
+    static bool enabled();
+    static void reset();
+    static void report(ostream &out);
+
+    /*
+     * count()
+     * Purpose:     adds to one of the calling thread's counters
+     */
+    static void count(Counter c, uint64_t n)
+    {
+        if (!local.enrolled) {enroll();}
+        local.counts[c] += n;
+    }
+    /*
+     * depth()
+     * Purpose:     records a recursion depth, keeping the deepest
+     */
+    static void depth(uint64_t d)
+    {
+        if (!local.enrolled) {enroll();}
+        if (d > local.peakDepth) {local.peakDepth = d;}
+    }
+
+    /* adds the wall time of its scope to a phase; a timer started inside
+       another takes its time out of the outer one's phase */
+    class Timer {
+    public:
+        Timer(Phase p);
+        ~Timer();
+    private:
+        Phase phase;
+        chrono::steady_clock::time_point start;
+        uint64_t inner; // nanoseconds of the timers nested in this one
+        Timer *outer;
+    };
+
+private:
+    /* one thread's counters; plain data, so reaching it costs no guard */
+    struct Block {
+        uint64_t counts[NUM_COUNTERS];
+        uint64_t nanos[NUM_PHASES];
+        uint64_t peakDepth;
+        bool enrolled;
+        Timer *timer; // innermost running timer
+    };
+
+    /* retires its thread's block when the thread exits */
+    struct Retirer {
+        ~Retirer() { retire(); }
+    };
+
+    static __thread Block local; // not thread_local: no wrapper call per use
+    static mutex registry;        // guards blocks and retired
+    static vector<Block *> blocks; // of every thread that has counted
+    static Block retired;         // sums of the threads that have exited
+
+    static void enroll();
+    static void retire();
+    static void add(Block &sum, const Block &b);
+};
+
+#ifdef STATS_ENABLED
+#define STAT_COUNT(counter, n) Stats::count(Stats::counter, n)
+#define STAT_DEPTH(d) Stats::depth(d)
+#define STAT_TIMER(phase) Stats::Timer statTimer(Stats::phase)
+#else
+#define STAT_COUNT(counter, n)
+#define STAT_DEPTH(d)
+#define STAT_TIMER(phase)
+#endif
+#endif
@@ -0,0 +1,101 @@
+/*
+ * ThreadPool.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of ThreadPool class.
+ */
+#include "ThreadPool.h"
+
+using namespace std;
+
+/*
+ * constructor: starts the workers
+ */
+ThreadPool::ThreadPool(int numThreads)
+{
+    running = 0;
+    stopping = false;
+    if (numThreads < 1) {numThreads = 1;}
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(thread(&ThreadPool::work, this, i));
+    }
+}
+/*
+ * destructor: finishes queued tasks, then joins the workers
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+/*
+ * size()
+ * Purpose:     get number of workers
+ * Parameters:  none
+ * Returns:     number of workers
+ */
+int ThreadPool::size() const
+{
+    return workers.size();
+}
+/*
+ * submit()
+ * Purpose:     queues a task
+ * Parameters:  task, called with the ID of the worker that runs it
+ * Returns:     none
+ */
+void ThreadPool::submit(function<void(int)> task)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        tasks.push(task);
+    }
+    ready.notify_one();
+}
+/*
+ * wait()
+ * Purpose:     blocks until every queued task has finished
+ * Parameters:  none
+ * Returns:     none
+ */
+void ThreadPool::wait()
+{
+    unique_lock<mutex> guard(lock);
+    while (!tasks.empty() or running > 0) {
+        finished.wait(guard);
+    }
+}
+/*
+ * work()
+ * Purpose:     worker loop: runs tasks until the pool is destroyed
+ * Parameters:  worker ID
+ * Returns:     none
+ */
+void ThreadPool::work(int id)
+{
+    while (true) {
+        function<void(int)> task;
+        {
+            unique_lock<mutex> guard(lock);
+            while (tasks.empty() and !stopping) {
+                ready.wait(guard);
+            }
+            if (tasks.empty()) {return;} // stopping and nothing left
+            task = tasks.front();
+            tasks.pop();
+            running++;
+        }
+        task(id);
+        {
+            lock_guard<mutex> guard(lock);
+            running--;
+            if (tasks.empty() and running == 0) {finished.notify_all();}
+        }
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * ThreadPool.h
+ * by: Valerie Zhang
+ *
+ * Purpose: A fixed pool of worker threads that run queued tasks. Each task
+ *          is told which worker runs it, so workers can keep their own
+ *          scratch state (e.g. an Engine each).
+ */
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool {
+public:
+    ThreadPool(int numThreads);
+    ~ThreadPool();
+
+    int size() const;
+    void submit(function<void(int)> task);
+    void wait();
+
+private:
+    vector<thread> workers;
+    queue<function<void(int)>> tasks;
+    mutex lock;
+    condition_variable ready;    // signalled when a task is queued
+    condition_variable finished; // signalled when the pool goes idle
+    int running;
+    bool stopping;
+
+    void work(int id);
+};
+#endif
@@ -0,0 +1,85 @@
+/*
+ * VariableElimination.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of VariableElimination class.
+ */
+#include "VariableElimination.h"
+
+using namespace std;
+
+/*
+ * constructor
+ */
+VariableElimination::VariableElimination(const Model &m, Heuristic h)
+    : Engine(m)
+{
+    heuristic = h;
+}
+/*
+ * ask()
+ * Purpose:     computes P(query, evidence) by bucket elimination
+ * Parameters:  context, query variable, evidence and distribution to fill
+ * Returns:     none
+ */
+void VariableElimination::ask(QueryContext &ctx, int query,
+                              const vector<int> &evidence,
+                              vector<double> &dist) const
+{
+    int n = model.numVars();
+    vector<int> pruned = evidence;
+    vector<bool> &needed = ctx.needed;
+    if (!relevant(query, pruned, needed)) {
+        dist.assign(model.getNumVal(query), 0);
+        return;
+    }
+    propagate(query, needed, pruned); // forced variables reduce like evidence
+    vector<bool> inGraph(n), eliminate(n);
+    for (int v = 0; v < n; v++) {
+        inGraph[v] = needed[v] and pruned[v] == NONE;
+        eliminate[v] = inGraph[v] and v != query;
+    }
+    vector<int> order = eliminationOrder(model, inGraph, eliminate, heuristic);
+    vector<int> position(n, order.size()); // query and evidence go last
+    for (size_t i = 0; i < order.size(); i++) {
+        position[order[i]] = i;
+    }
+
+    // each factor waits in the bucket of its first variable to eliminate
+    vector<vector<Factor>> buckets(order.size() + 1);
+    for (int v = 0; v < n; v++) {
+        if (!needed[v]) {continue;}
+        Factor f = Factor(model, v).reduce(pruned);
+        int first = order.size();
+        for (int i = 0; i < f.numVars(); i++) {
+            first = min(first, position[f.getVar(i)]);
+        }
+        buckets[first].push_back(f);
+    }
+    for (size_t b = 0; b < order.size(); b++) {
+        if (buckets[b].empty()) {continue;}
+        Factor f = buckets[b][0];
+        for (size_t i = 1; i < buckets[b].size(); i++) {
+            f = f.product(buckets[b][i]);
+        }
+        f = f.sumOut(order[b]);
+        if (logSpace) {f.rescale();} // a constant factor, normalized away
+        int first = order.size();
+        for (int i = 0; i < f.numVars(); i++) {
+            first = min(first, position[f.getVar(i)]);
+        }
+        buckets[first].push_back(f);
+        buckets[b].clear();
+    }
+
+    Factor result; // what is left only mentions the query
+    vector<Factor> &last = buckets[order.size()];
+    for (size_t i = 0; i < last.size(); i++) {
+        result = result.product(last[i]);
+        if (logSpace) {result.rescale();}
+    }
+    dist.assign(model.getNumVal(query), 0);
+    for (int i = 0; i < result.size(); i++) {
+        dist[i] = result.getValue(i);
+    }
+}
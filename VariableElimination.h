@@ -0,0 +1,29 @@
+/*
+ * VariableElimination.h
+ * by: Valerie Zhang
+ *
+ * Purpose: Variable elimination. Builds a factor from each CPT, reduces it
+ *          by the evidence and sums out the hidden variables one at a time,
+ *          so the cost grows with the treewidth instead of the number of
+ *          variables.
+ */
+#ifndef _VARIABLEELIMINATION_H_
+#define _VARIABLEELIMINATION_H_
+
+#include "Engine.h"
+#include "Factor.h"
+#include "Ordering.h"
+
+using namespace std;
+
+class VariableElimination : public Engine {
+public:
+    VariableElimination(const Model &m, Heuristic h);
+
+    void ask(QueryContext &ctx, int query, const vector<int> &evidence,
+             vector<double> &dist) const;
+
+private:
+    Heuristic heuristic;
+};
+#endif
@@ -0,0 +1,152 @@
+/*
+ * WorkStealingPool.cpp
+ * by: Valerie Zhang
+ *
+ * Purpose: An implementation of WorkStealingPool class.
+ */
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+static thread_local const WorkStealingPool *currentPool = NULL;
+static thread_local int currentWorker = 0;
+
+/*
+ * constructor: starts the workers
+ */
+WorkStealingPool::WorkStealingPool(int numThreads)
+{
+    if (numThreads < 1) {numThreads = 1;}
+    stopping = false;
+    queued = 0;
+    for (int i = 0; i <= numThreads; i++) {
+        queues.push_back(new Queue);
+    }
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(thread(&WorkStealingPool::work, this, i));
+    }
+}
+/*
+ * destructor: stops and joins the workers
+ */
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        lock_guard<mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    for (size_t i = 0; i < queues.size(); i++) {
+        delete queues[i];
+    }
+}
+/*
+ * size()
+ * Purpose:     get number of workers
+ * Parameters:  none
+ * Returns:     number of workers
+ */
+int WorkStealingPool::size() const
+{
+    return workers.size();
+}
+/*
+ * self()
+ * Purpose:     get the queue of the calling thread
+ * Parameters:  none
+ * Returns:     worker ID, or the shared queue for threads outside the pool
+ */
+int WorkStealingPool::self() const
+{
+    return currentPool == this ? currentWorker : workers.size();
+}
+/*
+ * spawn()
+ * Purpose:     queues a task on the calling thread's deque
+ * Parameters:  group the task belongs to and task
+ * Returns:     none
+ */
+void WorkStealingPool::spawn(Group &g, function<void()> task)
+{
+    g.pending++;
+    Queue *q = queues[self()];
+    {
+        lock_guard<mutex> guard(q->lock);
+        q->tasks.push_back(make_pair(&g, task));
+    }
+    {
+        lock_guard<mutex> guard(sleepLock); // a sleeper sees it or the notify
+        queued++;
+    }
+    wake.notify_one();
+}
+/*
+ * wait()
+ * Purpose:     runs tasks until every task in the group has finished,
+ *              sleeping while there are none to run
+ * Parameters:  group
+ * Returns:     none
+ */
+void WorkStealingPool::wait(Group &g)
+{
+    int id = self();
+    while (g.pending > 0) {
+        if (runOne(id)) {continue;}
+        unique_lock<mutex> guard(sleepLock);
+        wake.wait(guard, [this, &g]() {
+            return g.pending == 0 or queued > 0;
+        });
+    }
+}
+/*
+ * runOne()
+ * Purpose:     runs the newest task of this thread's deque, or else steals
+ *              the oldest task of another deque
+ * Parameters:  ID of the calling thread's deque
+ * Returns:     true if a task was run, false if every deque was empty
+ */
+bool WorkStealingPool::runOne(int id)
+{
+    int n = queues.size();
+    pair<Group *, function<void()>> task(NULL, function<void()>());
+    for (int k = 0; k < n and task.first == NULL; k++) {
+        Queue *q = queues[(id + k) % n];
+        lock_guard<mutex> guard(q->lock);
+        if (q->tasks.empty()) {continue;}
+        if (k == 0) { // own deque: newest first
+            task = q->tasks.back();
+            q->tasks.pop_back();
+        } else {      // someone else's: oldest first
+            task = q->tasks.front();
+            q->tasks.pop_front();
+        }
+        queued--; // never above the tasks in the deques
+    }
+    if (task.first == NULL) {return false;}
+    task.second();
+    if (--task.first->pending == 0) { // the group may be gone after this
+        { lock_guard<mutex> guard(sleepLock); }
+        wake.notify_all();
+    }
+    return true;
+}
+/*
+ * work()
+ * Purpose:     worker loop: runs or steals tasks, sleeping until one is
+ *              spawned when there are none, until the pool is destroyed
+ * Parameters:  worker ID
+ * Returns:     none
+ */
+void WorkStealingPool::work(int id)
+{
+    currentPool = this;
+    currentWorker = id;
+    while (!stopping) {
+        if (runOne(id)) {continue;}
+        unique_lock<mutex> guard(sleepLock);
+        wake.wait(guard, [this]() {return queued > 0 or stopping;});
+    }
+}
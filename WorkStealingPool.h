@@ -0,0 +1,59 @@
+/*
+ * WorkStealingPool.h
+ * by: Valerie Zhang
+ *
+ * Purpose: A fork-join pool for splitting one query into tasks. Every
+ *          worker has its own deque: it runs its newest task first and,
+ *          when it runs dry, steals the oldest task of another worker.
+ *          Threads waiting on a group run tasks instead of blocking, so
+ *          tasks may spawn and wait on tasks of their own; with nothing to
+ *          run, workers and waiters sleep until a task is spawned or the
+ *          group finishes, without polling.
+ */
+#ifndef _WORKSTEALINGPOOL_H_
+#define _WORKSTEALINGPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class WorkStealingPool {
+public:
+    /* a set of tasks that can be waited on together */
+    struct Group {
+        atomic<int> pending;
+        Group() : pending(0) {}
+    };
+
+    WorkStealingPool(int numThreads);
+    ~WorkStealingPool();
+
+    int size() const;
+    void spawn(Group &g, function<void()> task);
+    void wait(Group &g);
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<pair<Group *, function<void()>>> tasks;
+    };
+
+    vector<Queue *> queues; // one per worker, the last for other threads
+    vector<thread> workers;
+    atomic<bool> stopping;
+    atomic<int> queued;
+    mutex sleepLock;          // orders queued and group ends with sleeping
+    condition_variable wake;  // a task was spawned or a group finished
+
+    int self() const;
+    bool runOne(int id);
+    void work(int id);
+};
+#endif
@@ -5,18 +5,88 @@
  * Purpose: Run program for inference in a Bayes Net
  *
  */
-#include "CPT.h"
-#include "Node.h"
-#include "BN.h"
 #include "Inference.h"
 using namespace std;
 
+static void usage() {
+    cerr << "Usage: ./BayesNet infoFile [--engine enum|ve|jt|rc|ac|lw|gibbs]"
+         << "\n       [--order minfill|mindegree] [--cache entries]\n"
+         << "       [--cache-mb mb] [--prune on|off] [--batch queryFile] "
+         << "[--threads n]\n"
+         << "       [--compile out.bnb] [--samples n] [--error e] "
+         << "[--seed n]\n"
+         << "       [--chains n] [--stats on|off] [--serve path|port] "
+         << "[--log on|off]\n"
+         << "       [--circuit file.ac] [--score evidenceFile]\n";
+    exit(EXIT_FAILURE);
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        cerr << "Usage: ./BayesNet infoFile \n";
-        exit(EXIT_FAILURE);
+    if (argc < 2) {
+        usage();
+    }
+    Options opts;
+    for (int a = 2; a < argc; a++) {
+        string flag = argv[a];
+        if (a + 1 == argc) {usage();}
+        string arg = argv[++a];
+        if (flag == "--engine") {
+            opts.engine = arg;
+        } else if (flag == "--order") {
+            if (!parseHeuristic(arg, opts.heuristic)) {usage();}
+        } else if (flag == "--cache") {
+            opts.cacheSize = atoi(arg.c_str());
+        } else if (flag == "--cache-mb") {
+            opts.cacheMB = atoi(arg.c_str());
+        } else if (flag == "--prune") {
+            if (arg != "on" and arg != "off") {usage();}
+            opts.prune = (arg == "on");
+        } else if (flag == "--log") {
+            if (arg != "on" and arg != "off") {usage();}
+            opts.logSpace = (arg == "on");
+        } else if (flag == "--stats") {
+            if (arg != "on" and arg != "off") {usage();}
+            opts.stats = (arg == "on");
+            if (opts.stats and !Stats::enabled()) {
+                cerr << "Error: statistics are not compiled into this "
+                     << "build; rebuild with make STATS=1\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (flag == "--batch") {
+            opts.batchFile = arg;
+        } else if (flag == "--score") {
+            opts.scoreFile = arg;
+        } else if (flag == "--samples") {
+            opts.samples = atol(arg.c_str());
+        } else if (flag == "--error") {
+            opts.targetError = atof(arg.c_str());
+        } else if (flag == "--chains") {
+            opts.chains = atoi(arg.c_str());
+        } else if (flag == "--seed") {
+            opts.seed = strtoull(arg.c_str(), NULL, 10);
+        } else if (flag == "--compile") {
+            opts.compileFile = arg;
+        } else if (flag == "--circuit") {
+            opts.circuitFile = arg;
+        } else if (flag == "--serve") {
+            opts.serveAddress = arg;
+        } else if (flag == "--threads") {
+            opts.threads = atoi(arg.c_str());
+        } else {
+            usage();
+        }
+    }
+    Inference i(argv[1], opts);
+    if (!opts.compileFile.empty()) {
+        i.save(opts.compileFile);
+    } else if (!opts.serveAddress.empty()) {
+        i.serve(opts.serveAddress, opts.threads);
+    } else if (!opts.scoreFile.empty()) {
+        i.score(opts.scoreFile, opts.threads);
+    } else if (opts.batchFile.empty()) {
+        i.run();
+    } else {
+        i.runBatch(opts.batchFile, opts.threads);
     }
-    Inference i(argv[1]);
-    i.run();
     return 0;
-}
\ No newline at end of file
+}
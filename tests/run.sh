@@ -0,0 +1,129 @@
+#!/bin/bash
+#
+# run.sh
+# by: Valerie Zhang
+#
+# Purpose: Regression tests of the BayesNet program, run by make check from
+#          the top directory. Each test runs the program on a network in
+#          this directory and compares what it prints with what it should.
+#
+
+BN=./BayesNet
+DIR=tests
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+failed=0
+
+# expect name expected actual: reports whether the two strings are equal
+expect() {
+    if [ "$2" == "$3" ]; then
+        echo "ok: $1"
+    else
+        echo "FAILED: $1"
+        echo "--- expected"
+        echo "$2"
+        echo "--- got"
+        echo "$3"
+        failed=1
+    fi
+}
+
+# a failing map or mpe query must not swallow the results after it
+printf 'map A | C = t, D = f\nB\nmpe | C = t, D = f\nA | C = t\n' \
+    > "$TMP/queries.txt"
+for engine in enum ve jt rc ac; do
+    out=$($BN $DIR/deterministic.txt --engine $engine --batch \
+          "$TMP/queries.txt" 2> "$TMP/errors")
+    status=$?
+    expect "batch after a failed map ($engine)" \
+"
+
+P(t) = 0.5, P(f) = 0.5
+
+
+
+P(t) = 1, P(f) = 0
+0" "$out
+$status"
+    expect "batch errors ($engine)" \
+"Error: the evidence is impossible
+Error: the evidence is impossible" "$(grep Error "$TMP/errors")"
+done
+
+# evidence that pruning would drop is still checked, on every engine
+printf 'A | C = t, D = f\n* | C = t, D = f\nB | A = t, C = f\nB\n' \
+    > "$TMP/impossible.txt"
+for engine in enum ve jt rc ac lw gibbs; do
+    for prune in on off; do
+        out=$($BN $DIR/deterministic.txt --engine $engine --prune $prune \
+              --samples 1000 < "$TMP/impossible.txt" 2>&1)
+        expect "impossible evidence ($engine, prune $prune)" "3 1" \
+            "$(echo "$out" | grep -c 'evidence is impossible') \
+$(echo "$out" | grep -c 'P(t)')"
+    done
+done
+
+# evidence impossible only through zero CPT entries of another component
+printf 'Z t f\nA t f\nB t f\nQ t f\n# Parents\nA Z\nB Z\n# Tables\nZ\n0.5\n' \
+    > "$TMP/components.txt"
+printf 'A\nt 0.7\nf 0\nB\nt 0\nf 0.6\nQ\n0.3\n' >> "$TMP/components.txt"
+printf 'Q | A = t, B = t\nQ | A = t\nQ | A = t, B = t\n' > "$TMP/contra.txt"
+for engine in enum ve jt rc ac; do
+    out=$($BN "$TMP/components.txt" --engine $engine --prune off \
+          < "$TMP/contra.txt" 2>&1)
+    expect "impossible in another component ($engine)" "2 1" \
+        "$(echo "$out" | grep -c 'evidence is impossible') \
+$(echo "$out" | grep -c 'P(t) = 0.3')"
+done
+
+# answers prints what the program answers, without the loading banner
+answers() {
+    $BN "$@" 2>&1 | grep -v '^Loading'
+}
+
+# every exact engine agrees with enum, pruned or not and in log space or
+# not, on a network with three-valued variables and on an all-binary one
+# (which enum answers bit-packed); so do threads, compiled models, scoring
+# and mpe and map queries
+for net in mixed binary; do
+    ref=$(answers $DIR/$net.txt --engine enum --prune off --batch \
+          $DIR/queries.txt)
+    for engine in enum ve jt rc ac; do
+        wrong=""
+        for prune in on off; do
+            for log in on off; do
+                out=$(answers $DIR/$net.txt --engine $engine --prune $prune \
+                      --log $log --batch $DIR/queries.txt)
+                if [ "$out" != "$ref" ]; then
+                    wrong="$wrong prune $prune, log $log;"
+                fi
+            done
+        done
+        expect "engines agree ($net, $engine)" "" "$wrong"
+    done
+    expect "threads agree ($net)" "$ref" \
+        "$(answers $DIR/$net.txt --threads 4 --batch $DIR/queries.txt)"
+    answers $DIR/$net.txt --compile "$TMP/$net.bnb" < /dev/null > /dev/null
+    expect "compiled model agrees ($net)" "$ref" \
+        "$(answers "$TMP/$net.bnb" --batch $DIR/queries.txt)"
+    ref=$(answers $DIR/$net.txt --engine enum --score $DIR/rows.txt)
+    for engine in ve jt rc ac; do
+        expect "scores agree ($net, $engine)" "$ref" \
+            "$(answers $DIR/$net.txt --engine $engine --score $DIR/rows.txt)"
+    done
+done
+
+# a CPT row must add up to 1, whether its last probability is given or not
+printf 'A a b c\n# Parents\n# Tables\nA\n0.7 0.5\n' > "$TMP/over.txt"
+expect "implied probability below 0" \
+    "Error: $TMP/over.txt:5:1: probabilities add up to more than 1" \
+    "$(echo A | $BN "$TMP/over.txt" 2>&1 | grep Error)"
+printf 'A a b c\n# Parents\n# Tables\nA\n0.2 0.3 0.4\n' > "$TMP/under.txt"
+expect "full row not adding up to 1" \
+    "Error: $TMP/under.txt:5:1: probabilities do not add up to 1" \
+    "$(echo A | $BN "$TMP/under.txt" 2>&1 | grep Error)"
+printf 'A a b c\n# Parents\n# Tables\nA\n0.2 0.3 0.5\n' > "$TMP/full.txt"
+expect "full row adding up to 1" "P(a) = 0.2, P(b) = 0.3, P(c) = 0.5" \
+    "$(echo A | $BN "$TMP/full.txt" 2>&1 | grep 'P(')"
+
+exit $failed